@@ -0,0 +1,88 @@
+import binascii
+import struct
+import sys
+
+# Formato do bloco gravado pelo imu_codec.c (setores de 512 bytes, little-endian)
+TAM_BLOCO = 512
+MAGIC = 0x4D49
+CABECALHO = struct.Struct("<HBBHHII")  # magic, versao, canais, amostras, bytes, seq, id0
+CABECALHO_V2 = struct.Struct("<HBBHHIIIHH")  # ... sessao, crc, reservado
+NOMES = ["ax", "ay", "az", "gx", "gy", "gz", "temp"]
+NOMES_AHRS = ["qw", "qx", "qy", "qz"]  # Quaternion Q14 do AHRS (16384 = 1,0)
+
+def unzigzag(u):
+    return (u >> 1) ^ -(u & 1)
+
+def decodifica_bloco(bloco):
+    magic, versao, canais, amostras, nbytes, seq, id0 = CABECALHO.unpack_from(bloco)
+    if magic != MAGIC or versao not in (1, 2):
+        return None
+    p = CABECALHO.size
+    if versao == 2:
+        crc = CABECALHO_V2.unpack_from(bloco)[8]
+        zerado = bloco[:20] + b"\0\0" + bloco[22:]
+        if binascii.crc_hqx(zerado, 0) != crc:
+            return None
+        p = CABECALHO_V2.size
+    fim = p + nbytes
+    if canais == 0:
+        # Bloco de anotação: texto (ex.: a calibração usada na captura)
+        return seq, id0, 0, bloco[p:fim].decode("ascii")
+    linhas = []
+    anterior = list(struct.unpack_from("<%dh" % canais, bloco, p)) if amostras else []
+    p += 2 * canais
+    if amostras:
+        linhas.append(anterior[:])
+    for _ in range(1, amostras):
+        atual = []
+        for c in range(canais):
+            u, desloc = 0, 0
+            while True:
+                if p >= fim:
+                    raise ValueError("bloco %d truncado" % seq)
+                b = bloco[p]
+                p += 1
+                u |= (b & 0x7F) << desloc
+                desloc += 7
+                if not b & 0x80:
+                    break
+            v = (anterior[c] + unzigzag(u)) & 0xFFFF
+            atual.append(v - 0x10000 if v & 0x8000 else v)
+        linhas.append(atual)
+        anterior = atual
+    return seq, id0, canais, linhas
+
+def formata(id_amostra, canais):
+    # Mesmo texto que o CSV gravado pelo dispositivo: temperatura em °C com uma casa
+    campos = [str(id_amostra)] + [str(v) for v in canais[:6]]
+    campos.append("%.1f" % (canais[6] / 340.0 + 36.53))
+    campos += [str(v) for v in canais[7:]]
+    return ",".join(campos)
+
+def main(bin_path, csv_path):
+    with open(bin_path, "rb") as f:
+        dados = f.read()
+    escrito = False
+    with open(csv_path, "w", newline="\n") as saida:
+        for ofs in range(0, len(dados) - TAM_BLOCO + 1, TAM_BLOCO):
+            r = decodifica_bloco(dados[ofs:ofs + TAM_BLOCO])
+            if r is None:
+                print("Bloco inválido no offset %d, ignorado" % ofs)
+                continue
+            seq, id0, canais, linhas = r
+            if canais == 0:
+                if not escrito:
+                    saida.write(linhas)  # Comentário "# calib ..." antes do cabeçalho, como no CSV
+                continue
+            if not escrito:
+                extras = NOMES_AHRS if canais == 11 else ["c%d" % i for i in range(7, canais)]
+                saida.write(",".join(["id"] + NOMES + extras) + "\n")
+                escrito = True
+            for i, canal in enumerate(linhas):
+                saida.write(formata(id0 + i, canal) + "\n")
+    print("Arquivo %s decodificado em %s" % (bin_path, csv_path))
+
+if __name__ == "__main__":
+    entrada = sys.argv[1] if len(sys.argv) > 1 else "log_000.bin" #Alterar aqui o nome do log binário.
+    saida = sys.argv[2] if len(sys.argv) > 2 else entrada.rsplit(".", 1)[0] + ".csv"
+    main(entrada, saida)
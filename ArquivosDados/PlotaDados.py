@@ -3,8 +3,8 @@ import pandas as pd
 import matplotlib.pyplot as plt
 
 def main(csv_path):
-    # carrega CSV
-    df = pd.read_csv(csv_path)
+    # carrega CSV (a linha "# calib ..." do cabeçalho é comentário)
+    df = pd.read_csv(csv_path, comment="#")
 
     # extrai tempo, aceleração, giroscópio e temperatura
     t    = df.iloc[:, 0]
@@ -0,0 +1,130 @@
+#include <math.h>
+#include <stdio.h>
+#include "lib/ahrs.h"
+
+#define AHRS_1G 16384 // LSB por g na escala de ±2 g
+
+const char ahrs_cabecalho[] = ",qw,qx,qy,qz";
+
+ahrs_cfg_t ahrs_cfg = {
+    .ligado = false,
+    .kp_x10 = 10,   // Kp = 1,0
+    .ki_x1000 = 0}; // Sem integral: o bias já sai na calibração
+
+// Estado do filtro, exclusivo do core1 durante a captura
+static int32_t q[4];          // Quaternion Q30 (w, x, y, z)
+static int32_t integral[3];   // Correção integral acumulada, Q30 rad/s
+static uint32_t fator_gyro;   // LSB do giroscópio -> rad por amostra, Q40
+static int32_t kp_dt, ki_dt;  // Ganhos por amostra, Q30
+static int32_t dt_q30;        // Período em s, Q30
+static int32_t kp_partida;
+static uint32_t partida;      // Amostras restantes com Kp reforçado
+
+static inline int32_t mul_q30(int32_t a, int32_t b){
+    return (int32_t)(((int64_t)a * b) >> AHRS_Q);
+}
+
+static uint32_t raiz(uint32_t x){
+    uint32_t r = 0, bit = 1u << 30;
+    while (bit > x) bit >>= 2;
+    while (bit){
+        if (x >= r + bit){
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else
+            r >>= 1;
+        bit >>= 2;
+    }
+    return r;
+}
+
+void ahrs_imprimir(void){
+    if (ahrs_cfg.ligado)
+        printf("AHRS: Mahony, Kp %lu.%lu, Ki %lu.%03lu; quaternion Q14 nas colunas qw,qx,qy,qz\n",
+               (unsigned long)ahrs_cfg.kp_x10 / 10, (unsigned long)ahrs_cfg.kp_x10 % 10,
+               (unsigned long)ahrs_cfg.ki_x1000 / 1000, (unsigned long)ahrs_cfg.ki_x1000 % 1000);
+    else
+        printf("AHRS: desligado\n");
+}
+
+void ahrs_reiniciar(uint32_t periodo_us){
+    q[0] = 1 << AHRS_Q;
+    q[1] = q[2] = q[3] = 0;
+    integral[0] = integral[1] = integral[2] = 0;
+    fator_gyro = (uint32_t)((uint64_t)AHRS_RAD_LSB_Q40 * periodo_us / 1000000u);
+    kp_dt = (int32_t)(((uint64_t)ahrs_cfg.kp_x10 << AHRS_Q) * periodo_us / 10000000u);
+    ki_dt = (int32_t)(((uint64_t)ahrs_cfg.ki_x1000 << AHRS_Q) * periodo_us / 1000000000u);
+    dt_q30 = (int32_t)(((uint64_t)1 << AHRS_Q) * periodo_us / 1000000u);
+    // Kp · dt acima de 1/2 por amostra oscila: limita o reforço em taxas baixas
+    int64_t kp = (int64_t)kp_dt * AHRS_PARTIDA_GANHO;
+    kp_partida = kp > (1 << (AHRS_Q - 1)) ? 1 << (AHRS_Q - 1) : (int32_t)kp;
+    if (kp_dt > kp_partida) kp_dt = kp_partida;
+    partida = 1000000u / periodo_us;
+}
+
+void ahrs_amostra(int16_t c[]){
+    int32_t th[3]; // Rotação desta amostra, Q30 rad
+    for (int i = 0; i < 3; i++)
+        th[i] = (int32_t)(((int64_t)c[i + 3] * fator_gyro) >> 10);
+
+    int32_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    int32_t ax = c[0], ay = c[1], az = c[2];
+    uint32_t m = raiz((uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az));
+    // Fora de 0,5..1,5 g a aceleração não indica a vertical: só o giroscópio conta
+    if (m > AHRS_1G / 2 && m < AHRS_1G * 3 / 2){
+        // Direção medida e gravidade estimada pelo quaternion, ambas Q15
+        int32_t nx = (ax << 15) / (int32_t)m, ny = (ay << 15) / (int32_t)m, nz = (az << 15) / (int32_t)m;
+        int32_t vx = (mul_q30(q1, q3) - mul_q30(q0, q2)) >> 14;
+        int32_t vy = (mul_q30(q0, q1) + mul_q30(q2, q3)) >> 14;
+        int32_t vz = (mul_q30(q0, q0) - mul_q30(q1, q1) - mul_q30(q2, q2) + mul_q30(q3, q3)) >> 15;
+        // Erro = medida × estimada (Q30); vetores unitários, o produto vetorial cabe em 32 bits
+        int32_t e[3] = {ny * vz - nz * vy, nz * vx - nx * vz, nx * vy - ny * vx};
+        int32_t kp = partida ? kp_partida : kp_dt;
+        for (int i = 0; i < 3; i++){
+            integral[i] += mul_q30(e[i], ki_dt);
+            th[i] += mul_q30(e[i], kp);
+        }
+    }
+    if (ki_dt)
+        for (int i = 0; i < 3; i++) th[i] += mul_q30(integral[i], dt_q30);
+    if (partida) partida--;
+
+    // q += ½ q ⊗ (0, θ)
+    q[0] = q0 - (int32_t)(((int64_t)q1 * th[0] + (int64_t)q2 * th[1] + (int64_t)q3 * th[2]) >> (AHRS_Q + 1));
+    q[1] = q1 + (int32_t)(((int64_t)q0 * th[0] + (int64_t)q2 * th[2] - (int64_t)q3 * th[1]) >> (AHRS_Q + 1));
+    q[2] = q2 + (int32_t)(((int64_t)q0 * th[1] - (int64_t)q1 * th[2] + (int64_t)q3 * th[0]) >> (AHRS_Q + 1));
+    q[3] = q3 + (int32_t)(((int64_t)q0 * th[2] + (int64_t)q1 * th[1] - (int64_t)q2 * th[0]) >> (AHRS_Q + 1));
+
+    // Renormaliza com um passo de Newton de 1/sqrt em torno de 1: a norma nunca se afasta muito
+    int32_t n2 = mul_q30(q[0], q[0]) + mul_q30(q[1], q[1]) + mul_q30(q[2], q[2]) + mul_q30(q[3], q[3]);
+    int32_t f = (1 << AHRS_Q) + (((1 << AHRS_Q) - n2) >> 1);
+    for (int i = 0; i < 4; i++){
+        q[i] = mul_q30(q[i], f);
+        c[MPU6050_CANAIS + i] = (int16_t)((q[i] + (1 << 15)) >> 16);
+    }
+}
+
+void ahrs_euler(int16_t graus[3]){
+    // Só para exibição, poucas vezes por segundo: float basta aqui
+    const float k = 1.0f / (float)(1 << AHRS_Q);
+    float w = q[0] * k, x = q[1] * k, y = q[2] * k, z = q[3] * k;
+    float s = 2.0f * (w * y - z * x);
+    if (s > 1.0f) s = 1.0f;
+    if (s < -1.0f) s = -1.0f;
+    const float g = 57.29578f;
+    graus[0] = (int16_t)lroundf(atan2f(2.0f * (w * x + y * z), 1.0f - 2.0f * (x * x + y * y)) * g);
+    graus[1] = (int16_t)lroundf(asinf(s) * g);
+    graus[2] = (int16_t)lroundf(atan2f(2.0f * (w * z + x * y), 1.0f - 2.0f * (y * y + z * z)) * g);
+}
+
+void ahrs_desenhar(ssd1306_t *ssd, uint8_t y){
+    int16_t g[3];
+    char linha[16];
+    ahrs_euler(g);
+    // Ângulos já saem em [-180, 180]; o limite explícito mostra ao compilador que a linha cabe em 15 caracteres
+    int roll = g[0] < -180 ? -180 : g[0] > 180 ? 180 : g[0];
+    int pitch = g[1] < -90 ? -90 : g[1] > 90 ? 90 : g[1];
+    int yaw = g[2] < -180 ? -180 : g[2] > 180 ? 180 : g[2];
+    snprintf(linha, sizeof(linha), "%5d%5d%5d", roll, pitch, yaw); // Em graus
+    ssd1306_draw_string(ssd, linha, 0, y);
+}
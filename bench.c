@@ -0,0 +1,414 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "lib/bench.h"
+#include "lib/csv_fmt.h"
+#include "lib/imu_codec.h"
+#include "lib/fft_q15.h"
+#include "lib/ahrs.h"
+#include "hw_config.h"
+#include "sd_card.h"
+#include "sd_spi.h"
+#include "ff_stdio.h"
+
+// Gerador pseudoaleatório simples (LCG) para variar os canais sem depender de rand()
+static uint32_t semente = 12345;
+static int16_t aleatorio16(void){
+    semente = semente * 1664525u + 1013904223u;
+    return (int16_t)(semente >> 16);
+}
+
+static int compara_linha(uint32_t id, const int16_t accel[3], const int16_t gyro[3], int16_t temp){
+    char ref[80], nova[CSV_REG_MAX];
+    float temperature = (temp / 340.0f) + 36.53f;
+    int len_ref = sprintf(ref, "%lu,%d,%d,%d,%d,%d,%d,%.1f\n", (unsigned long)id,
+                          accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temperature);
+    size_t len = csv_fmt_registro(nova, id, accel, gyro, temp);
+    if ((size_t)len_ref == len && 0 == memcmp(ref, nova, len)) return 0;
+    printf("Divergência: \"%.*s\" != \"%.*s\"\n", len_ref - 1, ref, (int)len - 1, nova);
+    return 1;
+}
+
+static void bench_fmt(void){
+    int16_t accel[3] = {0, 0, 0}, gyro[3] = {0, 0, 0};
+    uint32_t erros = 0;
+
+    // Equivalência exaustiva: todas as leituras de temperatura e todos os valores de um canal
+    printf("Comparando csv_fmt com sprintf (65536 temperaturas)...\n");
+    for (int32_t t = INT16_MIN; t <= INT16_MAX; t++)
+        erros += compara_linha(1, accel, gyro, (int16_t)t);
+    printf("Comparando csv_fmt com sprintf (65536 valores de canal)...\n");
+    for (int32_t v = INT16_MIN; v <= INT16_MAX; v++){
+        accel[0] = accel[1] = accel[2] = (int16_t)v;
+        gyro[0] = gyro[1] = gyro[2] = (int16_t)-v;
+        erros += compara_linha((uint32_t)(v - INT16_MIN), accel, gyro, (int16_t)v);
+    }
+    printf("Comparando csv_fmt com sprintf (65536 linhas aleatórias)...\n");
+    for (uint32_t i = 0; i < 65536; i++){
+        for (int c = 0; c < 3; c++){
+            accel[c] = aleatorio16();
+            gyro[c] = aleatorio16();
+        }
+        erros += compara_linha(semente, accel, gyro, aleatorio16());
+    }
+    printf("Divergências: %lu\n", (unsigned long)erros);
+
+    // Tempo por linha nas duas implementações
+    const uint32_t linhas = 2000;
+    char buf[80];
+    volatile size_t total = 0;
+    uint32_t t0 = time_us_32();
+    for (uint32_t i = 0; i < linhas; i++){
+        int16_t t = aleatorio16();
+        float temperature = (t / 340.0f) + 36.53f;
+        total += sprintf(buf, "%lu,%d,%d,%d,%d,%d,%d,%.1f\n", (unsigned long)i,
+                         accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temperature);
+    }
+    uint32_t t_sprintf = time_us_32() - t0;
+    t0 = time_us_32();
+    for (uint32_t i = 0; i < linhas; i++)
+        total += csv_fmt_registro(buf, i, accel, gyro, aleatorio16());
+    uint32_t t_fmt = time_us_32() - t0;
+    printf("sprintf: %lu ns/linha\ncsv_fmt: %lu ns/linha\n",
+           (unsigned long)(t_sprintf * 1000ull / linhas), (unsigned long)(t_fmt * 1000ull / linhas));
+}
+
+// Sinal sintético parecido com os logs de ArquivosDados: IMU parado com ruído de poucas dezenas de LSB
+static void amostra_sintetica(int16_t amostra[7]){
+    static const int16_t repouso[7] = {10400, 300, 13500, 40, 360, -70, 2100};
+    for (int c = 0; c < 7; c++)
+        amostra[c] = (int16_t)(repouso[c] + (aleatorio16() >> 10));
+}
+
+// Fecha o bloco e confere a volta: amostras decodificadas e ids id0 + i do cabeçalho
+static bool confere_bloco(imu_codec_t *c, const int16_t *entrada, const uint32_t *ids, uint32_t n){
+    static int16_t saida[IMU_BLOCO_TAM * 7];
+    imu_bloco_cab_t cab;
+    imu_codec_finalizar(c);
+    if (!imu_codec_valido(c->bloco, &cab) || imu_codec_decodificar(c->bloco, saida, IMU_BLOCO_TAM) != (int)n ||
+        memcmp(entrada, saida, n * 7 * sizeof(int16_t)))
+        return false;
+    for (uint32_t i = 0; i < n; i++)
+        if (cab.id0 + i != ids[i]) return false;
+    return true;
+}
+
+static void bench_codec(void){
+    static uint8_t bloco[IMU_BLOCO_TAM];
+    static int16_t entrada[IMU_BLOCO_TAM * 7];
+    static uint32_t ids[IMU_BLOCO_TAM];
+    const uint32_t total = 20000;
+    imu_codec_t codec;
+    uint32_t blocos = 0, erros = 0, bytes_csv = 0, t_codec = 0;
+    uint32_t n = 0;
+    char linha[CSV_REG_MAX];
+
+    while (n < total){
+        imu_codec_iniciar(&codec, bloco, 7, 0x5E55A0, blocos, n + 1);
+        uint32_t no_bloco = 0;
+        while (n < total){
+            int16_t *a = &entrada[no_bloco * 7];
+            amostra_sintetica(a);
+            uint32_t t0 = time_us_32();
+            bool coube = imu_codec_adicionar(&codec, a);
+            t_codec += time_us_32() - t0;
+            if (!coube) break;
+            bytes_csv += csv_fmt_registro(linha, n + 1, &a[0], &a[3], a[6]);
+            ids[no_bloco++] = ++n;
+        }
+        blocos++;
+        if (!confere_bloco(&codec, entrada, ids, no_bloco)) erros++;
+    }
+    printf("Amostras: %lu em %lu blocos, blocos com erro: %lu\n",
+           (unsigned long)total, (unsigned long)blocos, (unsigned long)erros);
+    printf("CSV: %lu bytes, bin: %lu bytes (%lu.%02lux)\n", (unsigned long)bytes_csv,
+           (unsigned long)blocos * IMU_BLOCO_TAM,
+           (unsigned long)(bytes_csv / (blocos * IMU_BLOCO_TAM)),
+           (unsigned long)((bytes_csv * 100ull / (blocos * IMU_BLOCO_TAM)) % 100));
+    printf("Codificação: %lu ns/amostra\n", (unsigned long)(t_codec * 1000ull / total));
+
+    // Amostras descartadas pelo amostrador consomem o id sem chegar ao codec; o
+    // bloco fecha na lacuna como no pipeline, senão o decodificador renumeraria o resto
+    uint32_t id = 0, descartadas = 0, no_bloco = 0;
+    bool aberto = false, pronta = false; // pronta: amostra sorteada que ainda não entrou num bloco
+    int16_t a[7];
+    blocos = erros = n = 0;
+    while (n < total){
+        if (!pronta){
+            pronta = true;
+            id++;
+            if ((aleatorio16() & 63) == 0){
+                id++; // ~1,5% descartadas
+                descartadas++;
+            }
+            amostra_sintetica(a);
+        }
+        if (aberto && !imu_codec_continua(&codec, id)){
+            blocos++;
+            if (!confere_bloco(&codec, entrada, ids, no_bloco)) erros++;
+            aberto = false;
+            continue;
+        }
+        if (!aberto){
+            imu_codec_iniciar(&codec, bloco, 7, 0x5E55A0, blocos, id);
+            aberto = true;
+            no_bloco = 0;
+        }
+        if (!imu_codec_adicionar(&codec, a)){
+            blocos++;
+            if (!confere_bloco(&codec, entrada, ids, no_bloco)) erros++;
+            aberto = false;
+            continue;
+        }
+        memcpy(&entrada[no_bloco * 7], a, sizeof(a));
+        ids[no_bloco++] = id;
+        n++;
+        pronta = false;
+    }
+    if (aberto){
+        blocos++;
+        if (!confere_bloco(&codec, entrada, ids, no_bloco)) erros++;
+    }
+    printf("Com lacunas: %lu amostras e %lu descartadas em %lu blocos, blocos com erro: %lu\n",
+           (unsigned long)total, (unsigned long)descartadas, (unsigned long)blocos, (unsigned long)erros);
+}
+
+// Compara a FFT Q15 com uma DFT em double e mede o tempo por janela
+static void bench_fft(void){
+    static int16_t x[FFT_Q15_MAX], copia[FFT_Q15_MAX];
+    static fft_q15_c_t saida[FFT_Q15_MAX / 2 + 1];
+    for (uint32_t n = 64; n <= FFT_Q15_MAX; n <<= 1){
+        // Dois tons fora do centro dos bins mais ruído, ~ -3 dBFS
+        for (uint32_t i = 0; i < n; i++)
+            x[i] = (int16_t)(12000.0 * sin(2 * M_PI * 5.3 * i / n) + 8000.0 * cos(2 * M_PI * (n / 5.0) * i / n) +
+                             (aleatorio16() >> 6));
+        memcpy(copia, x, n * sizeof(int16_t));
+        fft_q15_real(copia, n, saida);
+        double erro2 = 0, sinal2 = 0, erro_max = 0;
+        for (uint32_t k = 0; k <= n / 2; k++){
+            double re = 0, im = 0;
+            for (uint32_t i = 0; i < n; i++){
+                double ang = 2 * M_PI * (double)((k * i) % n) / n;
+                re += x[i] * cos(ang);
+                im -= x[i] * sin(ang);
+            }
+            re /= n;
+            im /= n;
+            double er = saida[k].re - re, ei = saida[k].im - im;
+            double e = sqrt(er * er + ei * ei);
+            if (e > erro_max) erro_max = e;
+            erro2 += er * er + ei * ei;
+            sinal2 += re * re + im * im;
+        }
+        // Tempo: Hann + FFT real, como no estágio de espectro
+        const uint32_t repeticoes = 50;
+        uint32_t t0 = time_us_32();
+        for (uint32_t r = 0; r < repeticoes; r++){
+            memcpy(copia, x, n * sizeof(int16_t));
+            fft_q15_hann(copia, n);
+            fft_q15_real(copia, n, saida);
+        }
+        uint32_t us = (time_us_32() - t0) / repeticoes;
+        printf("n=%3lu: SNR %.1f dB, erro máx %.2f LSB, %lu us/janela (%lu ns/amostra)\n", (unsigned long)n,
+               10 * log10(sinal2 / (erro2 > 0 ? erro2 : 1e-12)), erro_max, (unsigned long)us,
+               (unsigned long)(us * 1000u / n));
+    }
+}
+
+// Gravidade no referencial do sensor para a orientação q (mesma convenção do filtro)
+static void gravidade(const double q[4], double v[3]){
+    v[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+    v[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+    v[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+// Ângulo em graus entre duas orientações
+static double distancia(const double a[4], const double b[4]){
+    double d = fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+    return 2 * acos(d > 1 ? 1 : d) * 180 / M_PI;
+}
+
+// Mahony em double com as mesmas entradas e ganhos, referência para o erro de ponto fixo
+static void mahony_double(double q[4], double integral[3], const int16_t c[7], double dt, double kp, double ki){
+    // kp já vem com o reforço de partida aplicado pelo chamador
+    const double rad_lsb = M_PI / (180.0 * 131.0);
+    double w[3] = {c[3] * rad_lsb, c[4] * rad_lsb, c[5] * rad_lsb};
+    double m = sqrt((double)c[0] * c[0] + (double)c[1] * c[1] + (double)c[2] * c[2]);
+    if (m > 8192 && m < 24576){
+        double n[3] = {c[0] / m, c[1] / m, c[2] / m}, v[3];
+        gravidade(q, v);
+        double e[3] = {n[1] * v[2] - n[2] * v[1], n[2] * v[0] - n[0] * v[2], n[0] * v[1] - n[1] * v[0]};
+        for (int i = 0; i < 3; i++){
+            integral[i] += ki * e[i] * dt;
+            w[i] += kp * e[i];
+        }
+    }
+    for (int i = 0; i < 3; i++) w[i] = (w[i] + integral[i]) * dt;
+    double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] = q0 - 0.5 * (q1 * w[0] + q2 * w[1] + q3 * w[2]);
+    q[1] = q1 + 0.5 * (q0 * w[0] + q2 * w[2] - q3 * w[1]);
+    q[2] = q2 + 0.5 * (q0 * w[1] - q1 * w[2] + q3 * w[0]);
+    q[3] = q3 + 0.5 * (q0 * w[2] + q1 * w[1] - q2 * w[0]);
+    double nq = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int i = 0; i < 4; i++) q[i] /= nq;
+}
+
+// Movimento sintético a 500 Hz: o filtro em ponto fixo contra o mesmo filtro em double e contra a verdade
+static void bench_ahrs(void){
+    const uint32_t periodo_us = 2000, total = 20000;
+    const double dt = periodo_us * 1e-6, lsb_rad = 180.0 * 131.0 / M_PI;
+    double real[4] = {cos(M_PI / 12), sin(M_PI / 12), 0, 0}; // Começa inclinado 30° em roll
+    double ref[4] = {1, 0, 0, 0}, integral[3] = {0, 0, 0};
+    double erro_ref = 0, erro_real = 0, soma_real = 0;
+    uint32_t medidas = 0, t_ahrs = 0;
+    amostra_t a;
+    ahrs_reiniciar(periodo_us);
+    for (uint32_t n = 0; n < total; n++){
+        // Rotação lenta e variável nos três eixos (até ~90 °/s), sem aceleração linear
+        double t = n * dt;
+        double w[3] = {1.2 * sin(0.7 * t), 0.8 * sin(1.1 * t + 1), 0.5 * cos(0.3 * t)}, g[3];
+        gravidade(real, g);
+        for (int i = 0; i < 3; i++){
+            a.canais[i] = (int16_t)lround(g[i] * 16384 + (aleatorio16() >> 11));
+            a.canais[i + 3] = (int16_t)lround(w[i] * lsb_rad + (aleatorio16() >> 13));
+        }
+        a.canais[6] = 0;
+        // Verdade: integra a rotação exata do passo
+        double ang = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * dt;
+        double s = ang > 0 ? sin(ang / 2) / (ang / dt) : 0, d[4] = {cos(ang / 2), w[0] * s, w[1] * s, w[2] * s};
+        double r0 = real[0], r1 = real[1], r2 = real[2], r3 = real[3];
+        real[0] = r0 * d[0] - r1 * d[1] - r2 * d[2] - r3 * d[3];
+        real[1] = r0 * d[1] + r1 * d[0] + r2 * d[3] - r3 * d[2];
+        real[2] = r0 * d[2] - r1 * d[3] + r2 * d[0] + r3 * d[1];
+        real[3] = r0 * d[3] + r1 * d[2] - r2 * d[1] + r3 * d[0];
+
+        uint32_t t0 = time_us_32();
+        ahrs_amostra(a.canais);
+        t_ahrs += time_us_32() - t0;
+        double kp = ahrs_cfg.kp_x10 / 10.0 * (n < 1000000u / periodo_us ? AHRS_PARTIDA_GANHO : 1);
+        mahony_double(ref, integral, a.canais, dt, kp, ahrs_cfg.ki_x1000 / 1000.0);
+        if (n < 2 * 1000000u / periodo_us) continue; // Convergência inicial
+        // Quaternion gravado (Q14), renormalizado: perto de 0° o acos amplifica o arredondamento
+        double fixo[4], nf = 0;
+        for (int i = 0; i < 4; i++){
+            fixo[i] = a.canais[MPU6050_CANAIS + i];
+            nf += fixo[i] * fixo[i];
+        }
+        for (int i = 0; i < 4; i++) fixo[i] /= sqrt(nf);
+        double er = distancia(fixo, ref), ev = distancia(fixo, real);
+        if (er > erro_ref) erro_ref = er;
+        if (ev > erro_real) erro_real = ev;
+        soma_real += ev;
+        medidas++;
+    }
+    uint32_t ns = (uint32_t)(t_ahrs * 1000ull / total);
+    printf("Ponto fixo x double: erro máx %.3f°\n", erro_ref);
+    printf("Ponto fixo x orientação real: erro médio %.2f°, máx %.2f° (sem magnetômetro o yaw deriva)\n",
+           soma_real / medidas, erro_real);
+    printf("Tempo: %lu ns/amostra (até %lu Hz com um core inteiro)\n", (unsigned long)ns,
+           (unsigned long)(ns ? 1000000000u / ns : 0));
+}
+
+// Latência das operações curtas do SD com o caminho por DMA e com o caminho por polling
+static void bench_sd(void){
+    static uint8_t setor[512];
+    sd_card_t *sd = sd_get_num() ? sd_get_by_num(0) : NULL;
+    if (!sd || !sd->mounted){
+        printf("Monte o cartão antes (mount).\n");
+        return;
+    }
+    const uint polled_max = sd->spi->polled_max;
+    uint32_t t[2][3];
+    for (int modo = 0; modo < 2; modo++){
+        sd->spi->polled_max = modo ? polled_max : 0; // 0: todo byte passa pelo DMA, como antes
+        const uint32_t bytes = 2000, comandos = 200, leituras = 50;
+        // Bytes de preenchimento com o cartão selecionado e ocioso: é o que cada poll de R1/token/busy faz
+        sd_spi_acquire(sd);
+        uint32_t t0 = time_us_32();
+        for (uint32_t i = 0; i < bytes; i++) sd_spi_write(sd, SPI_FILL_CHAR);
+        t[modo][0] = (time_us_32() - t0) * 1000u / bytes;
+        sd_spi_release(sd);
+        // CMD13 (SEND_STATUS) completo: comando, espera do R1 e resposta
+        t0 = time_us_32();
+        for (uint32_t i = 0; i < comandos; i++) sd->sd_test_com(sd);
+        t[modo][1] = (time_us_32() - t0) * 1000u / comandos;
+        // Leitura de um setor: comando, espera do token, 512 bytes por DMA e CRC
+        t0 = time_us_32();
+        for (uint32_t i = 0; i < leituras; i++) sd->read_blocks(sd, setor, 0, 1);
+        t[modo][2] = (time_us_32() - t0) * 1000u / leituras;
+    }
+    sd->spi->polled_max = polled_max;
+    static const char *nomes[3] = {"Byte SPI", "CMD13", "Leitura de 1 setor"};
+    for (int i = 0; i < 3; i++)
+        printf("%-19s DMA %7lu ns, polling %7lu ns (%lu.%lux)\n", nomes[i], (unsigned long)t[0][i],
+               (unsigned long)t[1][i], (unsigned long)(t[0][i] / (t[1][i] ? t[1][i] : 1)),
+               (unsigned long)(t[0][i] * 10 / (t[1][i] ? t[1][i] : 1) % 10));
+}
+
+// Um cenário da camada ff_stdio: fputc byte a byte, linhas com fprintf e releitura com fgets
+static bool stdio_cenario(int modo, char *buf, size_t tam, uint32_t t[3]){
+    const char *nome = "bench.tmp";
+    const uint32_t bytes = 16384, linhas = 1000;
+    FF_FILE *f = ff_fopen(nome, "w+");
+    if (!f) return false;
+    if (modo != FF_IOFBF || buf) ff_setvbuf(f, buf, modo, tam);
+    bool ok = true;
+    uint32_t t0 = time_us_32();
+    for (uint32_t i = 0; i < bytes && ok; i++) ok = ff_fputc('a' + i % 26, f) >= 0;
+    t[0] = (time_us_32() - t0) * 1000u / bytes;
+    t0 = time_us_32();
+    for (uint32_t i = 0; i < linhas && ok; i++) ok = ff_fprintf(f, "%lu,%d,%d,%d\n", (unsigned long)i, -(int)i, (int)i * 3, 16384) > 0;
+    ok = ok && ff_fflush(f) == 0;
+    t[1] = (time_us_32() - t0) * 1000u / linhas;
+    // Releitura: pula os bytes do fputc e confere as linhas
+    ok = ok && ff_fseek(f, bytes, FF_SEEK_SET) == 0;
+    char linha[48], esperado[48];
+    t0 = time_us_32();
+    for (uint32_t i = 0; i < linhas && ok; i++){
+        ok = ff_fgets(linha, sizeof(linha), f) != NULL;
+        snprintf(esperado, sizeof(esperado), "%lu,%d,%d,%d\n", (unsigned long)i, -(int)i, (int)i * 3, 16384);
+        ok = ok && 0 == strcmp(linha, esperado);
+    }
+    t[2] = (time_us_32() - t0) * 1000u / linhas;
+    ok = ff_fclose(f) == 0 && ok;
+    ff_remove(nome);
+    return ok;
+}
+
+static void bench_stdio(void){
+    static char grande[4096];
+    sd_card_t *sd = sd_get_num() ? sd_get_by_num(0) : NULL;
+    if (!sd || !sd->mounted){
+        printf("Monte o cartão antes (mount).\n");
+        return;
+    }
+    static const char *nomes[3] = {"Sem buffer", "Buffer 512 B", "Buffer 4 KiB"};
+    printf("%-13s %12s %12s %12s\n", "", "fputc", "fprintf", "fgets");
+    for (int c = 0; c < 3; c++){
+        uint32_t t[3];
+        bool ok = c == 0 ? stdio_cenario(FF_IONBF, NULL, 0, t)
+                : c == 1 ? stdio_cenario(FF_IOFBF, NULL, 0, t)
+                         : stdio_cenario(FF_IOFBF, grande, sizeof(grande), t);
+        if (!ok){
+            printf("%-13s falhou (errno %d)\n", nomes[c], errno);
+            continue;
+        }
+        printf("%-13s %9lu ns %9lu ns %9lu ns\n", nomes[c], (unsigned long)t[0], (unsigned long)t[1], (unsigned long)t[2]);
+    }
+}
+
+void run_bench(void){
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1){
+        printf("Uso: bench <fmt|codec|fft|ahrs|sd|stdio>\n");
+        return;
+    }
+    if (0 == strcmp(arg1, "fmt")) bench_fmt();
+    else if (0 == strcmp(arg1, "codec")) bench_codec();
+    else if (0 == strcmp(arg1, "fft")) bench_fft();
+    else if (0 == strcmp(arg1, "ahrs")) bench_ahrs();
+    else if (0 == strcmp(arg1, "sd")) bench_sd();
+    else if (0 == strcmp(arg1, "stdio")) bench_stdio();
+    else printf("Benchmark desconhecido: \"%s\"\n", arg1);
+}
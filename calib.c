@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "lib/calib.h"
+#include "crc.h"
+
+#define CALIB_MAGIC 0x42494C43u // "CLIB"
+#define CALIB_VERSAO 1
+#define CALIB_FLASH_OFS (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE) // Último setor, fora do binário
+#define CALIB_RUIDO_ACC 800     // Faixa máxima em repouso (~50 mg)
+#define CALIB_RUIDO_GYRO 400    // Idem para o giroscópio (~3 °/s)
+#define CALIB_ESPERA_US 60000000u
+
+// Registro na flash; o CRC cobre só os coeficientes
+typedef struct {
+    uint32_t magic;
+    uint16_t versao;
+    uint16_t crc;
+    calib_t c;
+} calib_flash_t;
+
+// Alterados só com a captura parada; a ISR do amostrador apenas lê
+static calib_t cal;
+static bool ativa;
+
+static const calib_t neutra = {
+    .accel_escala = {CALIB_UM, CALIB_UM, CALIB_UM}};
+
+static inline int16_t satura(int32_t v){
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+static int32_t div_arred(int32_t soma, int32_t n){
+    return soma >= 0 ? (soma + n / 2) / n : -((-soma + n / 2) / n);
+}
+
+void calib_carregar(void){
+    const calib_flash_t *f = (const calib_flash_t *)(XIP_BASE + CALIB_FLASH_OFS);
+    ativa = f->magic == CALIB_MAGIC && f->versao == CALIB_VERSAO &&
+            f->crc == crc16((const char *)&f->c, sizeof(f->c));
+    cal = ativa ? f->c : neutra;
+}
+
+bool calib_ativa(void){
+    return ativa;
+}
+
+void calib_aplicar(int16_t c[MPU6050_CANAIS]){
+    if (!ativa) return;
+    for (int i = 0; i < 3; i++){
+        // |a - offset| < 2^16 e ganho < 2^15: o produto cabe em 32 bits
+        int32_t a = ((int32_t)c[i] - cal.accel_offset[i]) * cal.accel_escala[i];
+        c[i] = satura((a + (1 << (CALIB_Q - 1))) >> CALIB_Q);
+        c[i + 3] = satura((int32_t)c[i + 3] - cal.gyro_bias[i]);
+    }
+}
+
+// Média de CALIB_AMOSTRAS leituras cruas de aceleração e giroscópio; false se a placa mexeu
+static bool medir(int32_t media[6]){
+    int32_t soma[6] = {0};
+    int16_t min[6], max[6];
+    int16_t c[MPU6050_CANAIS];
+    for (int n = 0; n < CALIB_AMOSTRAS; n++){
+        if (!mpu6050_ler_amostra(c)){
+            printf("[ERRO] Falha de leitura do MPU6050.\n");
+            return false;
+        }
+        for (int i = 0; i < 6; i++){
+            soma[i] += c[i];
+            if (n == 0 || c[i] < min[i]) min[i] = c[i];
+            if (n == 0 || c[i] > max[i]) max[i] = c[i];
+        }
+        sleep_ms(1);
+    }
+    for (int i = 0; i < 6; i++){
+        if (max[i] - min[i] > (i < 3 ? CALIB_RUIDO_ACC : CALIB_RUIDO_GYRO)){
+            printf("[ERRO] Placa em movimento durante a medição; repita com ela parada.\n");
+            return false;
+        }
+        media[i] = div_arred(soma[i], CALIB_AMOSTRAS);
+    }
+    return true;
+}
+
+bool calib_repouso(void){
+    int32_t m[6];
+    printf("Medindo com a placa parada e o eixo Z para cima...\n");
+    if (!medir(m)) return false;
+    calib_t n = ativa ? cal : neutra; // Ganhos de uma calibração de seis posições continuam valendo
+    int32_t g = (CALIB_1G << CALIB_Q) / n.accel_escala[2]; // 1 g em LSB crus
+    if (m[2] < g - g / 4 || m[2] > g + g / 4){
+        printf("[ERRO] Eixo Z não está para cima (az = %ld).\n", (long)m[2]);
+        return false;
+    }
+    for (int i = 0; i < 3; i++){
+        n.accel_offset[i] = (int16_t)(i == 2 ? m[2] - g : m[i]);
+        n.gyro_bias[i] = (int16_t)m[i + 3];
+    }
+    cal = n;
+    ativa = true;
+    return true;
+}
+
+// Espera Enter no serial; false se o usuário desistiu ou não respondeu
+static bool confirmar(void){
+    while (true){
+        int c = getchar_timeout_us(CALIB_ESPERA_US);
+        if (c == PICO_ERROR_TIMEOUT || c == 'q') return false;
+        if (c == '\r' || c == '\n') return true;
+    }
+}
+
+bool calib_seis_posicoes(void){
+    static const char eixos[] = "XYZ";
+    int32_t mais[3], menos[3], gyro[3] = {0};
+    uint8_t feitas = 0; // Bit 2*eixo (+) e 2*eixo+1 (-)
+    for (int tentativa = 0; feitas != 0x3F && tentativa < 12; tentativa++){
+        printf("Apoie a placa com outra face para cima e tecle Enter (q cancela). Faltam:");
+        for (int b = 0; b < 6; b++)
+            if (!(feitas & (1u << b))) printf(" %c%c", b & 1 ? '-' : '+', eixos[b / 2]);
+        printf("\n");
+        if (!confirmar()) return false;
+        int32_t m[6];
+        if (!medir(m)) continue;
+        // A face para cima é o eixo com maior |média|; a ordem das posições é livre
+        int e = 0;
+        for (int i = 1; i < 3; i++)
+            if ((m[i] < 0 ? -m[i] : m[i]) > (m[e] < 0 ? -m[e] : m[e])) e = i;
+        int b = 2 * e + (m[e] < 0);
+        if (feitas & (1u << b)){
+            printf("Posição %c%c já medida.\n", b & 1 ? '-' : '+', eixos[e]);
+            continue;
+        }
+        feitas |= 1u << b;
+        if (b & 1) menos[e] = m[e]; else mais[e] = m[e];
+        for (int i = 0; i < 3; i++) gyro[i] += m[i + 3];
+        printf("Posição %c%c: %ld\n", b & 1 ? '-' : '+', eixos[e], (long)m[e]);
+    }
+    if (feitas != 0x3F) return false;
+    calib_t n;
+    for (int i = 0; i < 3; i++){
+        // +1 g e -1 g: o centro é o offset, a distância entre eles é 2 g
+        int32_t faixa = mais[i] - menos[i];
+        int32_t escala = faixa > 0 ? (int32_t)(((uint32_t)2 * CALIB_1G << CALIB_Q) / (uint32_t)faixa) : 0;
+        if (escala < CALIB_ESCALA_MIN || escala > CALIB_ESCALA_MAX){
+            printf("[ERRO] Ganho do eixo %c fora da faixa esperada.\n", eixos[i]);
+            return false;
+        }
+        n.accel_offset[i] = (int16_t)div_arred(mais[i] + menos[i], 2);
+        n.accel_escala[i] = (uint16_t)escala;
+        n.gyro_bias[i] = (int16_t)div_arred(gyro[i], 6);
+    }
+    cal = n;
+    ativa = true;
+    return true;
+}
+
+// Roda com o outro core parado e as interrupções desligadas (flash_safe_execute)
+static void gravar_setor(void *pagina){
+    flash_range_erase(CALIB_FLASH_OFS, FLASH_SECTOR_SIZE);
+    flash_range_program(CALIB_FLASH_OFS, (const uint8_t *)pagina, FLASH_PAGE_SIZE);
+}
+
+static bool gravar(bool valida){
+    static uint8_t pagina[FLASH_PAGE_SIZE];
+    memset(pagina, 0xFF, sizeof(pagina));
+    if (valida){
+        calib_flash_t f = {.magic = CALIB_MAGIC, .versao = CALIB_VERSAO, .c = cal};
+        f.crc = crc16((const char *)&f.c, sizeof(f.c));
+        memcpy(pagina, &f, sizeof(f));
+    }
+    int r = flash_safe_execute(gravar_setor, pagina, 1000);
+    if (r != PICO_OK) printf("[ERRO] Falha ao gravar a flash (%d).\n", r);
+    return r == PICO_OK;
+}
+
+bool calib_salvar(void){
+    return ativa && gravar(true);
+}
+
+void calib_apagar(void){
+    ativa = false;
+    cal = neutra;
+    gravar(false);
+}
+
+size_t calib_registro(char *dst, size_t tam){
+    if (!ativa){
+        if (tam) dst[0] = '\0';
+        return 0;
+    }
+    int n = snprintf(dst, tam, "# calib gyro_bias=%d,%d,%d accel_offset=%d,%d,%d accel_escala_q14=%u,%u,%u\n",
+                     cal.gyro_bias[0], cal.gyro_bias[1], cal.gyro_bias[2],
+                     cal.accel_offset[0], cal.accel_offset[1], cal.accel_offset[2],
+                     cal.accel_escala[0], cal.accel_escala[1], cal.accel_escala[2]);
+    return n < 0 ? 0 : (size_t)n >= tam ? tam - 1 : (size_t)n;
+}
+
+void calib_imprimir(void){
+    char linha[CALIB_TXT_MAX];
+    if (calib_registro(linha, sizeof(linha)))
+        printf("Calibração ativa (escala Q14, 16384 = 1,0):\n%s", linha + 2);
+    else
+        printf("Calibração: desligada (dados crus)\n");
+}
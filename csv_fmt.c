@@ -0,0 +1,76 @@
+#include <stdbool.h>
+#include <string.h>
+#include "lib/csv_fmt.h"
+
+// Pares de dígitos "00".."99": cada divisão por 100 emite dois caracteres de uma vez
+static const char digitos2[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'};
+
+char *csv_fmt_u32(char *p, uint32_t v){
+    char tmp[10];
+    char *t = tmp + sizeof(tmp);
+    while (v >= 100){
+        uint32_t q = v / 100; // Divisor de hardware do RP2040
+        const char *d = &digitos2[(v - q * 100) * 2];
+        *--t = d[1];
+        *--t = d[0];
+        v = q;
+    }
+    if (v >= 10){
+        *--t = digitos2[v * 2 + 1];
+        *--t = digitos2[v * 2];
+    } else {
+        *--t = (char)('0' + v);
+    }
+    size_t n = (size_t)(tmp + sizeof(tmp) - t);
+    memcpy(p, t, n);
+    return p + n;
+}
+
+char *csv_fmt_i32(char *p, int32_t v){
+    if (v < 0){
+        *p++ = '-';
+        return csv_fmt_u32(p, 0u - (uint32_t)v);
+    }
+    return csv_fmt_u32(p, (uint32_t)v);
+}
+
+char *csv_fmt_temp(char *p, int16_t raw){
+    // Em décimos de grau: (raw / 340 + 36.53) * 10 = (10 * raw + 124202) / 340.
+    // O arredondamento é feito sobre a fração exata; o resto nunca cai em 170/340
+    // (empate), então o resultado coincide com o %.1f do float original.
+    int32_t num = 10 * (int32_t)raw + 124202;
+    bool negativo = num < 0;
+    uint32_t mag = negativo ? (uint32_t)-num : (uint32_t)num;
+    uint32_t decimos = (mag + 170) / 340;
+    if (negativo) *p++ = '-'; // printf também escreve "-0.0" para valores em (-0.05, 0)
+    p = csv_fmt_u32(p, decimos / 10);
+    *p++ = '.';
+    *p++ = (char)('0' + decimos % 10);
+    return p;
+}
+
+size_t csv_fmt_registro(char *dst, uint32_t id, const int16_t accel[3], const int16_t gyro[3], int16_t temp){
+    char *p = csv_fmt_u32(dst, id);
+    for (int i = 0; i < 3; i++){
+        *p++ = ',';
+        p = csv_fmt_i32(p, accel[i]);
+    }
+    for (int i = 0; i < 3; i++){
+        *p++ = ',';
+        p = csv_fmt_i32(p, gyro[i]);
+    }
+    *p++ = ',';
+    p = csv_fmt_temp(p, temp);
+    *p++ = '\n';
+    return (size_t)(p - dst);
+}
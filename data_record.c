@@ -7,12 +7,29 @@
 #include <math.h>
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
-#include "hardware/pwm.h"
 #include "lib/ssd1306.h"
 #include "lib/font.h"
+#include "lib/stats.h"
+#include "lib/bench.h"
+#include "lib/mpu6050.h"
+#include "lib/pipeline.h"
+#include "lib/log_store.h"
+#include "lib/log_commit.h"
+#include "lib/trigger.h"
+#include "lib/power.h"
+#include "lib/espectro.h"
+#include "lib/fft_q15.h"
+#include "lib/calib.h"
+#include "lib/ahrs.h"
+#include "lib/storage.h"
+#include "lib/eventos.h"
+#include "lib/feedback.h"
+#include "lib/ui_state.h"
+#include "lib/grafico.h"
 #include "hardware/rtc.h"
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
+#include "pico/flash.h"
 #include "ff.h"
 #include "diskio.h"
 #include "f_util.h"
@@ -42,12 +59,11 @@
 #define DISP_W 128       // Largura do OLED
 #define DISP_H 64        // Altura do OLED
 
+#define MANUTENCAO_MS 500 // Intervalo dos passos de recuperação de logs, só enquanto houver trabalho
+
 // Habilita interrupções GPIO para os pinos informados
 #define interrupcoes(botoes) gpio_set_irq_enabled_with_callback(botoes, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
 
-// Endereço I2C do MPU6050
-static int addr = 0x68; // Endereço do barramento I2C do MPU6050
-
 // Estrutura de controle do display SSD1306
 ssd1306_t ssd;
 
@@ -56,25 +72,24 @@ static bool logger_enabled;           // Habilita/desabilita logging
 static const uint32_t period = 1000; // Período de registro em milissegundos
 static absolute_time_t next_log_time; // Próximo tempo agendado para registro
 
-// Buffers de dados brutos do IMU
-int16_t acceleration[3], gyro[3], temp; // Leituras de aceleração, giroscópio e temperatura
-
 // Buffer para nome de arquivo de log
 static char filename[20]; // Armazena nome único para arquivo CSV
+static bool formato_bin = false; // Grava blocos comprimidos (.bin) em vez de CSV
+static uint32_t periodo_amostra_us = 100 * 1000; // Período do amostrador da captura
+static bool captura_continua = false;            // Captura sem fim, segmentada em vários arquivos
+static uint32_t segmento_mib = 64;               // Tamanho máximo de cada segmento (FAT32 limita a 4 GiB)
+static uint32_t segmento_min = 60;               // Duração máxima de cada segmento em minutos (0 = sem limite)
+static uint32_t resumo_s = 0;                    // Janela dos resumos estatísticos em segundos (0 = sem resumo)
+static bool resumo_so = false;                   // Grava só os resumos, sem o fluxo bruto
 
 // Flags para controle do cartão SD e captura
 volatile bool sd_montado = false;     // Flag de cartão SD montado
 volatile bool stop_capture = false;   // Requisição para parar captura
-volatile bool adentrando_a = false;   // Estado de pressão do botão A
-volatile bool adentrando_b = false;   // Estado de pressão do botão B
 volatile bool capture_running = false; // Flag de captura em andamento
-bool alteracao = false;                // Flag de atualização do display
-
-// Slice PWM para buzzer
-uint8_t slice = 0; // Número do slice PWM para o buzzer
+static bool recuperando = true;        // Ainda pode haver logs antigos a liberar
+static uint32_t capturas;              // Capturas iniciadas desde o boot
 
 // Buffers de texto para display
-char display_s[120]; // Texto atual a ser exibido no OLED
 char display_padrao[] = {
     "1.Montar SD    "
     "2.Desmontar SD "
@@ -86,7 +101,7 @@ char display_padrao[] = {
 }; // Strings do menu padrão concatenadas
 
 // Protótipos de funções com explicação de propósito
-void display(void); // Core1: atualiza continuamente o display OLED conforme flag 'alteracao'
+void display(void); // Core1: redesenha o OLED quando o estado publicado em ui_state muda
 void init_led(void); // Inicializa os GPIOs dos LEDs
 void init_bot(void); // Inicializa os GPIOs dos botões com pull-ups
 void bot_a_irq(void); // Trata ações do botão A fora da ISR
@@ -94,8 +109,6 @@ void bot_b_irq(void); // Trata ações do botão B fora da ISR
 void i2c_sensor(void); // Configura I2C para sensor MPU6050
 void i2c_display(void); // Configura I2C para display SSD1306
 void oled_config(void); // Inicializa e limpa o display SSD1306
-void pwm_setup(void); // Configura PWM para buzzer
-void pwm_beep(uint gpio, float duty, uint8_t times, float sec, bool ramp, bool use_end, bool end_high); // Gera sequência de bipes no buzzer
 void gpio_irq_handler(uint gpio, uint32_t events); // Callback de IRQ GPIO para botões
 
 // Funções utilitárias do SD
@@ -110,16 +123,32 @@ static void run_unmount(void); // Desmonta cartão SD
 static void run_getfree(void); // Verifica espaço livre no SD
 static void run_ls(void);      // Lista diretório
 static void run_cat(void);     // Exibe conteúdo de arquivo
+static void run_stats(void);   // Exibe estatísticas da captura
+static void run_formato(void); // Seleciona CSV ou binário comprimido
+static void run_taxa(void);    // Ajusta a taxa de amostragem da captura
+static void run_modo(void);    // Captura única (128 amostras) ou contínua
+static void run_segmento(void); // Limites de tamanho/duração de cada arquivo na captura contínua
+static void run_cota(void);    // Cota e piso de espaço livre do armazenamento rotativo
+static void run_commit(void);  // Intervalo entre confirmações da captura
+static void run_gatilho(void); // Detector de movimento que dispara a gravação
+static void run_evento(void);  // Janelas pré e pós-disparo de cada evento
+static void run_repouso(void); // Inatividade até o repouso e limiar de movimento que acorda
+static void run_resumo(void);  // Resumos estatísticos por janela
+static void run_espectro(void); // Espectro de vibração por janela
+static void run_relogio(void); // Fonte do relógio de amostragem: timer do RP2040 ou DATA_RDY do sensor
+static void run_calibrar(void); // Calibração do sensor gravada na flash
+static void run_ahrs(void);     // Orientação (quaternion) como canais extras
+static void run_tela(void);     // Tela do OLED durante a captura: estatísticas ou gráfico ao vivo
 
 // Funções auxiliares para captura de dados
-void generate_unique_filename(void);         // Gera nome único log_NNN.csv
-void capture_data_and_save(void);           // Captura dados IMU e grava em CSV
+void generate_unique_filename(void);         // Gera nome único log_NNNNN.csv ou log_NNNNN.bin
+void capture_data_and_save(void);           // Captura dados IMU e grava em CSV ou binário
 void read_file(const char *filename);        // Lê e imprime conteúdo de arquivo
+static void run_ultimo(void);                // Exibe o último arquivo capturado (tecla '4')
+static void menu_pedido(const char *fim, void (*cmd)(void)); // Comando do menu numérico atendido pelo core1
 
 static void run_help(void);  // Imprime menu de comandos disponíveis
 static void process_stdio(int cRxedChar); // Analisa e executa comandos seriais
-static void mpu6050_reset(void); // Reseta sensor MPU6050
-static void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp); // Lê dados brutos do IMU
 
 
 typedef void (*p_fn_t)();
@@ -136,171 +165,216 @@ static cmd_def_t cmds[] = {
     {"unmount", run_unmount, "unmount <drive#:>: Desmonta o cartão SD"},
     {"getfree", run_getfree, "getfree [<drive#:>]: Espaço livre"},
     {"ls", run_ls, "ls: Lista arquivos"},
-    {"cat", run_cat, "cat <filename>: Mostra conteúdo do arquivo"},
+    {"cat", run_cat, "cat <filename> [início] [bytes]: Mostra o arquivo inteiro ou um trecho"},
+    {"stats", run_stats, "stats: Estatísticas da captura"},
+    {"formato", run_formato, "formato <csv|bin>: Formato do arquivo de captura"},
+    {"taxa", run_taxa, "taxa <Hz>: Taxa de amostragem da captura (1 a 1000)"},
+    {"modo", run_modo, "modo <unico|continuo>: 128 amostras ou captura até parar"},
+    {"segmento", run_segmento, "segmento <MiB> <min>: Limites de cada arquivo na captura contínua"},
+    {"commit", run_commit, "commit <ms>: Intervalo entre confirmações (perda máxima em queda de energia)"},
+    {"cota", run_cota, "cota <MiB> <piso MiB>: Apaga os logs mais antigos acima da cota ou abaixo do piso livre"},
+    {"gatilho", run_gatilho, "gatilho <off|limiar <mg>|stalta <razão x10>>: Grava só em torno de eventos de movimento"},
+    {"evento", run_evento, "evento <pré> <pós>: Amostras gravadas antes e depois de cada disparo"},
+    {"resumo", run_resumo, "resumo <s|off> [so]: Mín/máx/média/RMS/variância por janela em log_NNNNN.res (so = sem o bruto)"},
+    {"espectro", run_espectro, "espectro <pontos|off> [bandas]: Bandas de vibração por FFT em log_NNNNN.esp e no OLED"},
+    {"relogio", run_relogio, "relogio <timer|drdy>: Amostragem pelo timer do RP2040 ou pelo DATA_RDY do MPU6050"},
+    {"repouso", run_repouso, "repouso <s> <mg>: Dorme após s segundos sem uso e acorda com movimento (0 s = nunca)"},
+    {"calibrar", run_calibrar, "calibrar [repouso|6|off]: Bias do giroscópio e offset/ganho do acelerômetro, gravados na flash"},
+    {"ahrs", run_ahrs, "ahrs <on|off> [Kp x10] [Ki x1000]: Orientação por filtro de Mahony gravada como qw,qx,qy,qz"},
+    {"tela", run_tela, "tela <stats|acc|gyro> [escala mg|dps] [hw|2d|sw]: Tela da captura; o botão B alterna durante a captura"},
+    {"bench", run_bench, "bench <fmt|codec|fft|ahrs|sd|stdio>: Benchmarks e testes de equivalência"},
     {"help", run_help, "help: Mostra comandos disponíveis"}};
 
+// Comandos de uma tecla do menu; o resto vai para o shell
+static void tecla(int c){
+    process_stdio(c);
+    if (c == '1'){ // Monta o SD card se pressionar '1'
+        printf("\nMontando o SD...\n");
+        ui_mostrar(true, "Montando o SD  ");
+        feedback_leds(FEEDBACK_VERDE | FEEDBACK_VERMELHO, 0);
+        feedback_beep(0.5f, 1, 0.25f, false, false, false);
+        run_mount();
+        feedback_leds(FEEDBACK_VERDE, 0);
+        printf("\nEscolha o comando (8 = help):  ");
+        ui_mostrar(false, display_padrao);
+    }
+    if (c == '2'){ // Desmonta o SD card se pressionar '2'
+        printf("\nDesmontando o SD. Aguarde...\n");
+        ui_mostrar(true, "Desmontando SD ");
+        feedback_leds(0, 0);
+        feedback_beep(0.5f, 2, 0.25f, false, false, false);
+        run_unmount();
+        printf("\nEscolha o comando (8 = help):  ");
+        ui_mostrar(false, display_padrao);
+    }
+    if (c == '3'){ // Lista diretórios e os arquivos se pressionar '3'
+        printf("\nListagem de arquivos no cartão SD.\n");
+        ui_mostrar(true, "List. arquivos ");
+        feedback_leds(FEEDBACK_VERDE, 0);
+        feedback_beep(0.5f, 1, 0.1f, false, false, false);
+        menu_pedido("\nListagem concluída.\n", run_ls); // Menu volta quando o core1 terminar
+    }
+    if (c == '4'){ // Exibe o conteúdo do último arquivo capturado na sessão arquivo ao pressionar '4'
+        printf("\nExibindo conteúdo do último arquivo...");
+        ui_mostrar(true, "Ultimo arquivo ");
+        feedback_leds(FEEDBACK_VERDE | FEEDBACK_AZUL, 0);
+        feedback_beep(0.5f, 2, 0.1f, false, false, false);
+        menu_pedido("", run_ultimo);
+    }
+    if (c == '5'){ // Obtém o espaço livre no SD card se pressionar '5'
+        printf("\nObtendo espaço livre no SD.\n\n");
+        ui_mostrar(true, "Checando espaço");
+        feedback_leds(FEEDBACK_VERDE | FEEDBACK_AZUL, 0);
+        feedback_beep(0.5f, 1, 0.7f, false, false, false); 
+        menu_pedido("\nEspaço livre obtido.\n", run_getfree);
+    }
+    if (c == '6'){ // Captura dados e salva no arquivo se pressionar '6'
+        printf("\nCapturando os dados...\n");
+        ui_mostrar(true, "Captura de dado");
+        feedback_leds(FEEDBACK_VERMELHO, 250); // Pisca enquanto grava
+        feedback_beep(0.5f, 1, 1.2f, false, false, false);
+        capture_running = true;
+        generate_unique_filename();
+        capture_data_and_save();
+        capture_running = false;
+        feedback_leds(FEEDBACK_VERDE, 0);
+        printf("\nEscolha o comando (8 = help):  ");
+        ui_mostrar(false, display_padrao);
+    }
+    if (c == '7'){ // Formata o SD card se pressionar '7'
+        printf("\nProcesso de formatação do SD iniciado. Aguarde...\n");
+        ui_mostrar(true, "Formatando SD  ");
+        feedback_leds(FEEDBACK_VERDE | FEEDBACK_AZUL | FEEDBACK_VERMELHO, 0);
+        feedback_beep(0.8f, 3, 1.0f, false, false, false);
+        run_format();
+        feedback_leds(FEEDBACK_VERDE, 0);
+        printf("\nFormatação concluída.\n\n");
+        printf("\nEscolha o comando (8 = help):  ");
+        ui_mostrar(false, display_padrao);
+    }
+    if (c == '8') run_help(); // Exibe os comandos disponíveis no serial monitor se pressionar '8'
+}
+
+static void tratar_evento(evento_t ev){
+    switch (ev){
+        case EVENTO_SERIAL: {
+            power_atividade(); // Acorda o sensor antes de usá-lo
+            int c;
+            while (PICO_ERROR_TIMEOUT != (c = getchar_timeout_us(0))) tecla(c);
+            recuperando = true;
+            break;
+        }
+        case EVENTO_BOTAO_A:
+            power_atividade();
+            bot_a_irq();
+            recuperando = true;
+            break;
+        case EVENTO_BOTAO_B:
+            power_atividade();
+            bot_b_irq();
+            recuperando = true;
+            break;
+        case EVENTO_MOVIMENTO:
+            power_atividade();
+            break;
+        case EVENTO_TEMPO:
+            recuperando = log_store_recuperar_passo(); // Libera logs antigos aos poucos
+            break;
+        default:
+            break;
+    }
+}
+
 int main(){
-    alteracao = true;
-    snprintf(display_s, sizeof(display_s), "Inicializando");
+    ui_mostrar(true, "Inicializando");
     stdio_init_all();
     multicore_launch_core1(display);
     init_led();
     init_bot();
-    pwm_setup();
+    feedback_iniciar(buzz_a, green_led, blue_led, red_led);
     i2c_sensor();
-    gpio_put(green_led, 1);
-    gpio_put(red_led, 1);
+    feedback_leds(FEEDBACK_VERDE | FEEDBACK_VERMELHO, 0);
     sleep_ms(5000);
     time_init();
     interrupcoes(bot_a);
     interrupcoes(bot_b);
-    gpio_put(green_led, 0);
-    gpio_put(red_led, 0);
+    feedback_leds(0, 0);
     bi_decl(bi_2pins_with_func(i2c_sda, i2c_scl, GPIO_FUNC_I2C));
     stdio_flush();
     run_help();
     mpu6050_reset();
-    alteracao = false;
-    snprintf(display_s, sizeof(display_s), "%s", display_padrao);
+    calib_carregar();
+    power_iniciar();
+    ui_mostrar(false, display_padrao);
+    eventos_iniciar();
     while (true){
-        mpu6050_read_raw(acceleration, gyro, &temp);
-        int cRxedChar = getchar_timeout_us(0);
-        if (PICO_ERROR_TIMEOUT != cRxedChar) process_stdio(cRxedChar);
-
-        if (cRxedChar == '1'){ // Monta o SD card se pressionar '1'
-            printf("\nMontando o SD...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Montando o SD  ");
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 1);
-            pwm_beep(buzz_a, 0.5f, 1, 0.25f, false, false, false);
-            run_mount();
-            sleep_ms(100);
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("\nEscolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        }
-        if (cRxedChar == '2'){ // Desmonta o SD card se pressionar '2'
-            printf("\nDesmontando o SD. Aguarde...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Desmontando SD ");            
-            gpio_put(green_led, 0);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            pwm_beep(buzz_a, 0.5f, 2, 0.25f, false, false, false);
-            run_unmount();
-            printf("\nEscolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        }
-        if (cRxedChar == '3'){ // Lista diretórios e os arquivos se pressionar '3'
-            printf("\nListagem de arquivos no cartão SD.\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "List. arquivos ");
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            pwm_beep(buzz_a, 0.5f, 1, 0.1f, false, false, false);
-            run_ls();
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("\nListagem concluída.\n");
-            printf("\nEscolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
+        storage_concluir(); // Saída dos comandos que o core1 terminou; cada conclusão acorda o core0 (__sev)
+        evento_t ev;
+        while (eventos_proximo(&ev)){
+            uint32_t inicio = time_us_32(), n = capturas;
+            tratar_evento(ev);
+            if (capturas == n) stats_ocupado(time_us_32() - inicio); // A captura contabiliza a própria carga
         }
-        if (cRxedChar == '4'){ // Exibe o conteúdo do último arquivo capturado na sessão arquivo ao pressionar '4'
-            printf("\nExibindo conteúdo do último arquivo...");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Ultimo arquivo ");
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 1);
-            gpio_put(red_led, 0);
-            pwm_beep(buzz_a, 0.5f, 2, 0.1f, false, false, false);
-            read_file(filename);
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("Escolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        }
-        if (cRxedChar == '5'){ // Obtém o espaço livre no SD card se pressionar '5'
-            printf("\nObtendo espaço livre no SD.\n\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Checando espaço");
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 1);
-            gpio_put(red_led, 0);   
-            pwm_beep(buzz_a, 0.5f, 1, 0.7f, false, false, false); 
-            run_getfree();
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("\nEspaço livre obtido.\n");
-            printf("\nEscolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        }
-        if (cRxedChar == '6'){ // Captura dados e salva no arquivo se pressionar '6'
-            printf("\nCapturando os dados...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Captura de dado");
-            gpio_put(green_led, 0);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 1);
-            pwm_beep(buzz_a, 0.5f, 1, 1.2f, false, false, false);
-            generate_unique_filename();
-            capture_data_and_save();
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("\nEscolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        }
-        if (cRxedChar == '7'){ // Formata o SD card se pressionar '7'
-            printf("\nProcesso de formatação do SD iniciado. Aguarde...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Formatando SD  ");
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 1);
-            gpio_put(red_led, 1);
-            pwm_beep(buzz_a, 0.8f, 3, 1.0f, false, false, false);
-            run_format();
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("\nFormatação concluída.\n\n");
-            printf("\nEscolha o comando (8 = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        }
-        if (cRxedChar == '8') run_help(); // Exibe os comandos disponíveis no serial monitor se pressionar '8'
-        bot_a_irq();
-        bot_b_irq();
-        sleep_ms(500);
+        uint32_t ms = power_verificar(); // Repouso por inatividade
+        if (recuperando && (!ms || ms > MANUTENCAO_MS)) ms = MANUTENCAO_MS;
+        eventos_agendar(ms);
+        if (!eventos_pendentes()) power_dormir(); // Eventos publicados depois do teste deixam o __sev marcado
     }
     return 0;
 }
 
 void display(void){
+    flash_safe_execute_core_init(); // Core1 pausa sozinho enquanto o core0 grava a calibração na flash
     i2c_display();
     oled_config();
+    storage_iniciar();
+    uint32_t ultimo_quadro = 0;
+    bool tela_acesa = true;
+    ui_estado_t ui;
+    uint32_t geracao = 0;
+    ui_telemetria_t tel = {0};
+    uint32_t geracao_tel = 0;
+    bool redesenhar = false;
         while(true){
-        if(alteracao){
+        uint32_t inicio_quadro = time_us_32();
+        if(capture_running || pipeline_ativo()){
+            // Durante a captura o core1 é o estágio de codificação; o OLED é redesenhado a cada 100 ms,
+            // mas só os números que mudaram vão pelo I2C (o quadro inteiro prendia o core1 por ~25 ms)
+            bool trabalhou = pipeline_core1_passo();
+            if (storage_passo()) trabalhou = true; // Um setor ao cartão; amostras seguem codificadas enquanto ele está ocupado
+            if (pipeline_ativo() && grafico_desenhar(&ssd)){
+                trabalhou = true; // Gráfico ao vivo: troca de tela ou uma coluna nova
+            } else if (grafico_tela() == TELA_STATS && inicio_quadro - ultimo_quadro >= 100 * 1000){
+                grafico_parar(&ssd); // Troca de tela com o pipeline já parado: a rolagem ainda pode estar ligada
+                ui_ler_telemetria(&tel, &geracao_tel); // Sem publicação nova, redesenha o último instantâneo
+                stats_desenhar(&ssd, &tel);
+                if (ahrs_cfg.ligado) ahrs_desenhar(&ssd, 48); // Roll, pitch e yaw sob as estatísticas
+                if (espectro_ativo()) espectro_desenhar(&ssd, ahrs_cfg.ligado ? 56 : 48, ahrs_cfg.ligado ? 8 : 16);
+                ssd1306_flush_dirty(&ssd);
+                ultimo_quadro = inicio_quadro;
+                trabalhou = true;
+            }
+            stats_ocupado(trabalhou ? time_us_32() - inicio_quadro : 0); // Voltas vazias não contam como carga
+            if (!trabalhou) __wfe(); // Acorda com nova amostra (__sev do amostrador) ou setor devolvido
+            continue;
+        }
+        grafico_parar(&ssd); // Fim da captura com o gráfico na tela: a RAM do painel volta a aceitar escrita
+        bool atendeu = storage_passo(); // Comandos do shell: listagem, leitura, espaço livre
+        if (tela_acesa != power_tela_ligada()){
+            tela_acesa = !tela_acesa;
+            ssd1306_command(&ssd, SET_DISP | (tela_acesa ? 0x01 : 0x00));
+        }
+        if (ui_ler(&ui, &geracao)) redesenhar = true;
+        if (tela_acesa && redesenhar){
             ssd1306_fill(&ssd, false);
-            ssd1306_draw_string(&ssd, display_s, 0, 25);  
-            ssd1306_send_data(&ssd);
-        }else {
-            ssd1306_draw_string(&ssd, display_s, 0, 0);  
-            ssd1306_send_data(&ssd);
+            ssd1306_draw_string(&ssd, ui.texto, 0, ui.alteracao ? 25 : 0);
+            ssd1306_flush_dirty(&ssd);
+            redesenhar = false;
         }
+        stats_ocupado(time_us_32() - inicio_quadro);
+        if (atendeu) continue; // Próximo passo do pedido sem dormir
+        // Nada a redesenhar até uma publicação, um pedido ou a troca do repouso: todos acordam com __sev
+        power_dormir();
     }
 }
 
@@ -321,66 +395,43 @@ void init_bot(void){
 }
 
 void bot_a_irq(void){
-    if(adentrando_a){
-        if(!capture_running){
-            capture_running = true;
-            stop_capture = false;
-            printf("\nCapturando os dados...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Captura de dado");
-            gpio_put(green_led, 0);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 1);
-            pwm_beep(buzz_a, 0.5f, 1, 1.2f, false, false, false);
-            generate_unique_filename();
-            capture_data_and_save();
-            capture_running = false;
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);                
-            printf("\nEscolha o comando (h = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-        } 
-    }
-    adentrando_a = false;
+    if(!capture_running){
+        capture_running = true;
+        stop_capture = false;
+        printf("\nCapturando os dados...\n");
+        ui_mostrar(true, "Captura de dado");
+        feedback_leds(FEEDBACK_VERMELHO, 250); // Pisca enquanto grava
+        feedback_beep(0.5f, 1, 1.2f, false, false, false);
+        generate_unique_filename();
+        capture_data_and_save();
+        capture_running = false;
+        feedback_leds(FEEDBACK_VERDE, 0);
+        printf("\nEscolha o comando (h = help):  ");
+        ui_mostrar(false, display_padrao);
+    } 
 }
 
 void bot_b_irq(void){
-    if(adentrando_b){
-        if(!sd_montado){
-            printf("\nMontando o SD...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Montando o SD  ");
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 1);
-            pwm_beep(buzz_a, 0.5f, 1, 0.5f, false, false, false);
-            run_mount();
-            sleep_ms(100);
-            gpio_put(green_led, 1);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            printf("\nEscolha o comando (h = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-            sd_montado = true;
-        } else {
-            printf("\nDesmontando o SD. Aguarde...\n");
-            alteracao = true;
-            snprintf(display_s, sizeof(display_s), "Desmontando SD ");
-            gpio_put(green_led, 0);
-            gpio_put(blue_led, 0);
-            gpio_put(red_led, 0);
-            pwm_beep(buzz_a, 0.5f, 2, 0.5f, false, false, false);
-            run_unmount();
-            printf("\nEscolha o comando (h = help):  ");
-            alteracao = false;
-            snprintf(display_s, sizeof(display_s), "%s", display_padrao);
-            sd_montado = false;
-        }
+    if(!sd_montado){
+        printf("\nMontando o SD...\n");
+        ui_mostrar(true, "Montando o SD  ");
+        feedback_leds(FEEDBACK_VERDE | FEEDBACK_VERMELHO, 0);
+        feedback_beep(0.5f, 1, 0.5f, false, false, false);
+        run_mount();
+        feedback_leds(FEEDBACK_VERDE, 0);
+        printf("\nEscolha o comando (h = help):  ");
+        ui_mostrar(false, display_padrao);
+        sd_montado = true;
+    } else {
+        printf("\nDesmontando o SD. Aguarde...\n");
+        ui_mostrar(true, "Desmontando SD ");
+        feedback_leds(0, 0);
+        feedback_beep(0.5f, 2, 0.5f, false, false, false);
+        run_unmount();
+        printf("\nEscolha o comando (h = help):  ");
+        ui_mostrar(false, display_padrao);
+        sd_montado = false;
     }
-    adentrando_b = false;
 }
 
 void i2c_sensor(void){
@@ -408,73 +459,24 @@ void oled_config(void){
     ssd1306_send_data(&ssd);
 }
 
-void pwm_setup(void){
-    gpio_set_function(buzz_a, GPIO_FUNC_PWM);
-    slice = pwm_gpio_to_slice_num(buzz_a);
-    pwm_set_clkdiv(slice, 32.0f);
-    pwm_set_wrap(slice, 7812);
-    pwm_set_enabled(slice, true);
-}
-void pwm_beep(uint gpio, float duty, uint8_t times, float sec, bool ramp, bool use_end, bool end_high) {
-    uint32_t wrap  = 7812;
-    const int steps = 100;
-    float total_ms = sec * 1000.0f;
-    float phase_ms = ramp ? (total_ms / 2.0f) : total_ms;
-    float delay_ms = phase_ms / steps;
-
-    if (times == 0 && !ramp) {
-        pwm_set_chan_level(slice, PWM_CHAN_A, duty * wrap);
+void gpio_irq_handler(uint gpio, uint32_t events){
+    if (gpio == MPU6050_INT_PIN){
+        if (!pipeline_drdy_irq()) eventos_publicar(EVENTO_MOVIMENTO); // DRDY é pulso de amostra da captura
         return;
     }
-
-    for (int t = 0; t < (times>0?times:1); t++) {
-        if (ramp) {
-            // up
-            for (int i = 0; i <= steps; i++) {
-                pwm_set_gpio_level(buzz_a, duty * i/steps * wrap);
-                sleep_ms((uint)delay_ms);
-            }
-            // down
-            for (int i = steps; i >= 0; i--) {
-                 pwm_set_gpio_level(buzz_a, duty * i/steps * wrap);
-                sleep_ms((uint)delay_ms);
-            }
-            if (use_end) {
-                if (end_high) {
-                    // sobe de novo e termina no pico
-                    for (int i = 0; i <= steps; i++) {
-                         pwm_set_gpio_level(buzz_a, duty * i/steps * wrap);
-                        sleep_ms((uint)delay_ms);
-                    }
-                    break;
-                } else {
-                    break; // termina em baixo (já está em zero)
-                }
-            }
-        } else {
-             pwm_set_gpio_level(buzz_a, duty * wrap);
-            sleep_ms((uint)total_ms);
-             pwm_set_gpio_level(buzz_a, 0);
-        }
-        sleep_ms(100);
-    }
-    // se não usar modo de término com alto, garante nível baixo
-    if (!(ramp && use_end && end_high))
-         pwm_set_gpio_level(buzz_a, 0);
-}
-
-void gpio_irq_handler(uint gpio, uint32_t events){
     uint64_t current_time = to_ms_since_boot(get_absolute_time());
     static uint64_t last_time_a = 0 , last_time_b = 0;
     if(gpio == bot_a && (current_time - last_time_a > 300)){
         if(capture_running){
+            // A amostragem para aqui mesmo; o laço da captura só esvazia o que falta
             stop_capture = true;
-            adentrando_a = false;
-        } else adentrando_a = true;
+            pipeline_interromper();
+        } else eventos_publicar(EVENTO_BOTAO_A);
 
         last_time_a = current_time;
     } else if(gpio == bot_b &&(current_time - last_time_b > 300)){
-        adentrando_b = true;
+        if(capture_running) grafico_trocar(); // Durante a captura o botão B alterna estatísticas e gráficos
+        else eventos_publicar(EVENTO_BOTAO_B);
         last_time_b = current_time;
     }
 }
@@ -494,6 +496,42 @@ static FATFS *sd_get_fs_by_name(const char *name){
     return NULL;
 }
 
+// Comandos que leem o cartão viram pedidos ao servidor de armazenamento do core1;
+// a saída e o prompt saem no callback, e o laço principal segue livre enquanto isso
+static const char *menu_fim;   // Mensagem final do comando do menu em andamento (NULL = comando digitado)
+static bool prompt_adiado;     // O callback imprime o prompt do comando digitado
+
+// Encerra um comando do shell: prompt do comando digitado ou menu restaurado (ctx = mensagem final)
+static void shell_fechar(const storage_pedido_t *p){
+    if (!p->ctx){
+        printf("\n> ");
+        stdio_flush();
+        return;
+    }
+    printf("%s", (const char *)p->ctx);
+    feedback_leds(FEEDBACK_VERDE, 0);
+    printf("\nEscolha o comando (8 = help):  ");
+    ui_mostrar(false, display_padrao);
+}
+
+static void shell_enviar(storage_pedido_t *p, storage_cb_t cb){
+    p->cb = cb;
+    p->ctx = (void *)menu_fim;
+    if (!menu_fim) prompt_adiado = true;
+    menu_fim = NULL;
+    storage_enviar(p);
+}
+
+static void menu_pedido(const char *fim, void (*cmd)(void)){
+    menu_fim = fim;
+    cmd();
+    if (menu_fim){ // Nada foi enviado (erro de argumento): restaura já
+        storage_pedido_t p = {.ctx = (void *)menu_fim};
+        menu_fim = NULL;
+        shell_fechar(&p);
+    }
+}
+
 static void run_setrtc(void){
     const char *dateStr = strtok(NULL, " ");
     if (!dateStr){
@@ -549,6 +587,7 @@ static void run_setrtc(void){
 }
 
 static void run_format(void){
+    storage_esperar(); // Controle do volume não é reentrante: o servidor precisa estar parado
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
@@ -564,6 +603,7 @@ static void run_format(void){
         printf("f_mkfs error: %s (%d)\n", FRESULT_str(fr), fr);
 }
 static void run_mount(void){
+    storage_esperar();
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
@@ -580,9 +620,12 @@ static void run_mount(void){
     sd_card_t *pSD = sd_get_by_name(arg1);
     myASSERT(pSD);
     pSD->mounted = true;
+    log_commit_recuperar(); // Antes da varredura: tamanhos dos logs já reparados
+    log_store_iniciar();
     printf("Processo de montagem do SD ( %s ) concluído\n", pSD->pcName);
 }
 static void run_unmount(void){
+    storage_esperar();
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
@@ -591,6 +634,7 @@ static void run_unmount(void){
         printf("Unknown logical drive number: \"%s\"\n", arg1);
         return;
     }
+    log_store_encerrar();
     FRESULT fr = f_unmount(arg1);
     if (FR_OK != fr){
         printf("f_unmount error: %s (%d)\n", FRESULT_str(fr), fr);
@@ -602,151 +646,621 @@ static void run_unmount(void){
     pSD->m_Status |= STA_NOINIT; // in case medium is removed
     printf("SD ( %s ) desmontado\n", pSD->pcName);
 }
+static void getfree_fim(const storage_pedido_t *p){
+    if (FR_OK != p->res)
+        printf("f_getfree error: %s (%d)\n", FRESULT_str(p->res), p->res);
+    else
+        printf("%10lu KiB total drive space.\n%10lu KiB available.\n", (unsigned long)p->total, (unsigned long)p->n);
+    shell_fechar(p);
+}
 static void run_getfree(void){
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
-    DWORD fre_clust, fre_sect, tot_sect;
-    FATFS *p_fs = sd_get_fs_by_name(arg1);
-    if (!p_fs){
+    if (!sd_get_fs_by_name(arg1)){
         printf("Unknown logical drive number: \"%s\"\n", arg1);
         return;
     }
-    FRESULT fr = f_getfree(arg1, &fre_clust, &p_fs);
-    if (FR_OK != fr){
-        printf("f_getfree error: %s (%d)\n", FRESULT_str(fr), fr);
-        return;
-    }
-    tot_sect = (p_fs->n_fatent - 2) * p_fs->csize;
-    fre_sect = fre_clust * p_fs->csize;
-    printf("%10lu KiB total drive space.\n%10lu KiB available.\n", tot_sect / 2, fre_sect / 2);
+    storage_pedido_t p = {.op = STORAGE_ESPACO};
+    snprintf(p.nome, sizeof(p.nome), "%s", arg1);
+    shell_enviar(&p, getfree_fim);
 }
 static void run_ls(void){
     const char *arg1 = strtok(NULL, " ");
-    if (!arg1)
-        arg1 = "";
-    char cwdbuf[FF_LFN_BUF] = {0};
-    FRESULT fr;
-    char const *p_dir;
-    if (arg1[0]){
-        p_dir = arg1;
-    } else{
-        fr = f_getcwd(cwdbuf, sizeof cwdbuf);
-        if (FR_OK != fr){
-            printf("f_getcwd error: %s (%d)\n", FRESULT_str(fr), fr);
-            return;
-        }
-        p_dir = cwdbuf;
-    }
-    printf("Directory Listing: %s\n", p_dir);
-    DIR dj;
-    FILINFO fno;
-    memset(&dj, 0, sizeof dj);
-    memset(&fno, 0, sizeof fno);
-    fr = f_findfirst(&dj, &fno, p_dir, "*");
-    if (FR_OK != fr){
-        printf("f_findfirst error: %s (%d)\n", FRESULT_str(fr), fr);
+    storage_pedido_t p = {.op = STORAGE_LISTAR};
+    snprintf(p.nome, sizeof(p.nome), "%s", arg1 ? arg1 : "");
+    shell_enviar(&p, shell_fechar);
+}
+static void cat_fim(const storage_pedido_t *p){
+    if (FR_OK != p->res)
+        printf("f_open error: %s (%d)\n", FRESULT_str(p->res), p->res);
+    shell_fechar(p);
+}
+// cat com faixa: o core1 lê um trecho por pedido e o core0 o imprime no callback
+static char cat_trecho[256];
+static uint32_t cat_restante;
+static void cat_faixa(const storage_pedido_t *p){
+    if (FR_OK != p->res){
+        printf("f_read error: %s (%d)\n", FRESULT_str(p->res), p->res);
+        shell_fechar(p);
         return;
     }
-    while (fr == FR_OK && fno.fname[0]){
-        const char *pcWritableFile = "writable file",
-                   *pcReadOnlyFile = "read only file",
-                   *pcDirectory = "directory";
-        const char *pcAttrib;
-        if (fno.fattrib & AM_DIR)
-            pcAttrib = pcDirectory;
-        else if (fno.fattrib & AM_RDO)
-            pcAttrib = pcReadOnlyFile;
-        else
-            pcAttrib = pcWritableFile;
-        printf("%s [%s] [size=%llu]\n", fno.fname, pcAttrib, fno.fsize);
-
-        fr = f_findnext(&dj, &fno);
+    fwrite(cat_trecho, 1, p->n, stdout);
+    cat_restante -= p->n;
+    if (p->n < p->len || !cat_restante){ // Fim do arquivo ou da faixa
+        printf("\n");
+        shell_fechar(p);
+        return;
     }
-    f_closedir(&dj);
+    storage_pedido_t prox = *p;
+    prox.pos += p->n;
+    prox.len = cat_restante < sizeof(cat_trecho) ? cat_restante : sizeof(cat_trecho);
+    storage_enviar(&prox);
 }
 static void run_cat(void){
     char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    const char *arg3 = strtok(NULL, " ");
     if (!arg1){
         printf("Missing argument\n");
         return;
     }
-    FIL fil;
-    FRESULT fr = f_open(&fil, arg1, FA_READ);
-    if (FR_OK != fr){
-        printf("f_open error: %s (%d)\n", FRESULT_str(fr), fr);
+    storage_pedido_t p = {.op = STORAGE_MOSTRAR};
+    snprintf(p.nome, sizeof(p.nome), "%s", arg1);
+    if (!arg2){
+        shell_enviar(&p, cat_fim);
         return;
     }
-    char buf[256];
-    while (f_gets(buf, sizeof buf, &fil)){
-        printf("%s", buf);
+    cat_restante = arg3 ? (uint32_t)strtoul(arg3, NULL, 10) : UINT32_MAX;
+    if (!cat_restante) return;
+    p.op = STORAGE_LER;
+    p.pos = (uint32_t)strtoul(arg2, NULL, 10);
+    p.dados = cat_trecho;
+    p.len = cat_restante < sizeof(cat_trecho) ? cat_restante : sizeof(cat_trecho);
+    shell_enviar(&p, cat_faixa);
+}
+static void run_stats(void){
+    stats_imprimir();
+}
+static void run_formato(void){
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "csv"))
+        formato_bin = false;
+    else if (arg1 && 0 == strcmp(arg1, "bin"))
+        formato_bin = true;
+    else
+        printf("Uso: formato <csv|bin>\n");
+    printf("Formato de captura: %s\n", formato_bin ? "bin (delta + zigzag + varint)" : "csv");
+}
+static void run_taxa(void){
+    const char *arg1 = strtok(NULL, " ");
+    int hz = arg1 ? atoi(arg1) : 0;
+    if (hz >= 1 && hz <= 1000)
+        periodo_amostra_us = 1000000u / (uint32_t)hz;
+    else
+        printf("Uso: taxa <Hz> (1 a 1000)\n");
+    printf("Taxa de amostragem: %lu Hz\n", (unsigned long)(1000000u / periodo_amostra_us));
+}
+
+static void run_modo(void){
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "unico"))
+        captura_continua = false;
+    else if (arg1 && 0 == strcmp(arg1, "continuo"))
+        captura_continua = true;
+    else
+        printf("Uso: modo <unico|continuo>\n");
+    printf("Modo de captura: %s\n", captura_continua ? "contínuo (até parar)" : "único (128 amostras)");
+}
+static void run_segmento(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    int mib = arg1 ? atoi(arg1) : 0;
+    if (mib >= 1 && mib <= 4095 && arg2){
+        segmento_mib = (uint32_t)mib;
+        segmento_min = (uint32_t)atoi(arg2);
+    } else
+        printf("Uso: segmento <MiB (1 a 4095)> <min (0 = sem limite)>\n");
+    printf("Segmento: até %lu MiB", (unsigned long)segmento_mib);
+    if (segmento_min) printf(" ou %lu min", (unsigned long)segmento_min);
+    printf("\n");
+}
+
+static void run_cota(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    if (arg1 && arg2)
+        log_store_cota((uint32_t)atoi(arg1), (uint32_t)atoi(arg2));
+    else
+        printf("Uso: cota <MiB (0 = sem cota)> <piso livre MiB (0 = sem piso)>\n");
+    log_store_imprimir();
+}
+
+static void run_commit(void){
+    const char *arg1 = strtok(NULL, " ");
+    int ms = arg1 ? atoi(arg1) : 0;
+    if (ms >= 10 && ms <= 60000)
+        log_commit_periodo((uint32_t)ms);
+    else
+        printf("Uso: commit <ms> (10 a 60000)\n");
+    printf("Confirmação a cada %lu ms\n", (unsigned long)log_commit_periodo_ms());
+}
+
+static void run_gatilho(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    int v = arg2 ? atoi(arg2) : 0;
+    if (arg1 && 0 == strcmp(arg1, "off"))
+        trigger_cfg.modo = TRIGGER_DESLIGADO;
+    else if (arg1 && 0 == strcmp(arg1, "limiar") && v >= 1 && v <= 2000){
+        trigger_cfg.modo = TRIGGER_LIMIAR;
+        trigger_cfg.limiar_mg = (uint32_t)v;
+    } else if (arg1 && 0 == strcmp(arg1, "stalta") && v >= 11 && v <= 1000){
+        trigger_cfg.modo = TRIGGER_STALTA;
+        trigger_cfg.razao_x10 = (uint32_t)v;
+    } else
+        printf("Uso: gatilho <off|limiar <mg (1 a 2000)>|stalta <razão x10 (11 a 1000)>>\n");
+    if (trigger_cfg.modo == TRIGGER_LIMIAR)
+        printf("Gatilho: |a| fora de 1 g +- %lu mg\n", (unsigned long)trigger_cfg.limiar_mg);
+    else if (trigger_cfg.modo == TRIGGER_STALTA)
+        printf("Gatilho: STA/LTA > %lu.%lu\n", (unsigned long)trigger_cfg.razao_x10 / 10,
+               (unsigned long)trigger_cfg.razao_x10 % 10);
+    else
+        printf("Gatilho: desligado\n");
+}
+
+static void run_evento(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    int pre = arg1 ? atoi(arg1) : -1;
+    int pos = arg2 ? atoi(arg2) : 0;
+    if (pre >= 0 && pre <= TRIGGER_PRE_MAX && pos >= 1){
+        trigger_cfg.pre = (uint32_t)pre;
+        trigger_cfg.pos = (uint32_t)pos;
+    } else
+        printf("Uso: evento <pré (0 a %d)> <pós (>= 1)>\n", TRIGGER_PRE_MAX);
+    printf("Evento: %lu amostras antes, %lu depois do disparo\n", (unsigned long)trigger_cfg.pre, (unsigned long)trigger_cfg.pos);
+}
+
+static void run_resumo(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    int seg = arg1 ? atoi(arg1) : -1;
+    uint32_t hz = 1000000u / periodo_amostra_us;
+    uint32_t max_s = WIN_STATS_MAX / hz; // As somas só são exatas até WIN_STATS_MAX amostras
+    if (max_s > 3600) max_s = 3600;
+    if (arg1 && 0 == strcmp(arg1, "off"))
+        resumo_s = 0;
+    else if (seg >= 1 && (uint32_t)seg <= max_s){
+        resumo_s = (uint32_t)seg;
+        resumo_so = arg2 && 0 == strcmp(arg2, "so");
+    } else
+        printf("Uso: resumo <s (1 a %lu com %lu Hz)|off> [so]\n", (unsigned long)max_s, (unsigned long)hz);
+    if (resumo_s)
+        printf("Resumo a cada %lu s (%lu amostras)%s\n", (unsigned long)resumo_s, (unsigned long)(resumo_s * hz),
+               resumo_so ? ", sem o fluxo bruto" : ", ao lado do fluxo bruto");
+    else
+        printf("Resumo desligado\n");
+}
+
+static void run_espectro(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    int n = arg1 ? atoi(arg1) : 0;
+    int b = arg2 ? atoi(arg2) : 8;
+    if (arg1 && 0 == strcmp(arg1, "off"))
+        espectro_config(0, 8);
+    else if (n >= 16 && n <= FFT_Q15_MAX && !(n & (n - 1)) && b >= 1 && b <= ESPECTRO_BANDAS_MAX)
+        espectro_config((uint32_t)n, (uint32_t)b);
+    else
+        printf("Uso: espectro <pontos (16 a %d, potência de 2)|off> [bandas (1 a %d)]\n", FFT_Q15_MAX, ESPECTRO_BANDAS_MAX);
+    espectro_imprimir();
+}
+
+static void run_relogio(void){
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "timer"))
+        pipeline_relogio(PIPE_RELOGIO_TIMER);
+    else if (arg1 && 0 == strcmp(arg1, "drdy"))
+        pipeline_relogio(PIPE_RELOGIO_DRDY);
+    else
+        printf("Uso: relogio <timer|drdy>\n");
+    printf("Relógio de amostragem: %s\n", pipeline_relogio_atual() == PIPE_RELOGIO_DRDY ?
+           "DATA_RDY do MPU6050 (1 kHz / (1 + div), a partir de 4 Hz)" : "timer do RP2040");
+}
+
+static void run_repouso(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    int mg = arg2 ? atoi(arg2) : 0;
+    if (arg1 && mg >= 2 && mg <= 510)
+        power_config((uint32_t)atoi(arg1), (uint32_t)mg);
+    else
+        printf("Uso: repouso <s (0 = nunca)> <mg (2 a 510)>\n");
+    power_imprimir();
+}
+
+static void run_calibrar(void){
+    const char *arg1 = strtok(NULL, " ");
+    bool ok = false;
+    if (!arg1){
+        calib_imprimir();
+        return;
     }
-    fr = f_close(&fil);
-    if (FR_OK != fr)
-        printf("f_open error: %s (%d)\n", FRESULT_str(fr), fr);
+    if (0 == strcmp(arg1, "off")){
+        calib_apagar();
+        calib_imprimir();
+        return;
+    }
+    if (0 == strcmp(arg1, "repouso"))
+        ok = calib_repouso();
+    else if (0 == strcmp(arg1, "6"))
+        ok = calib_seis_posicoes();
+    else {
+        printf("Uso: calibrar [repouso|6|off]\n");
+        return;
+    }
+    if (!ok)
+        printf("Calibração não alterada.\n");
+    else if (calib_salvar())
+        printf("Calibração gravada na flash.\n");
+    calib_imprimir();
+}
+
+static void run_ahrs(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    const char *arg3 = strtok(NULL, " ");
+    int kp = arg2 ? atoi(arg2) : (int)ahrs_cfg.kp_x10;
+    int ki = arg3 ? atoi(arg3) : (int)ahrs_cfg.ki_x1000;
+    if (arg1 && 0 == strcmp(arg1, "off"))
+        ahrs_cfg.ligado = false;
+    else if (arg1 && 0 == strcmp(arg1, "on") && kp >= 0 && kp <= 100 && ki >= 0 && ki <= 1000){
+        ahrs_cfg.ligado = true;
+        ahrs_cfg.kp_x10 = (uint32_t)kp;
+        ahrs_cfg.ki_x1000 = (uint32_t)ki;
+    } else
+        printf("Uso: ahrs <on|off> [Kp x10 (0 a 100)] [Ki x1000 (0 a 1000)]\n");
+    ahrs_imprimir();
 }
 
-// Função para capturar dados e salvar no arquivo *.csv
+static void run_tela(void){
+    const char *arg1 = strtok(NULL, " ");
+    const char *arg2 = strtok(NULL, " ");
+    const char *arg3 = strtok(NULL, " ");
+    int modo = -1, rolagem = -1;
+    for (int i = 0; arg1 && i < TELA_MODOS; i++)
+        if (0 == strcmp(arg1, grafico_telas[i])) modo = i;
+    for (int i = 0; arg3 && i < ROLAGEM_MODOS; i++)
+        if (0 == strcmp(arg3, grafico_rolagens[i])) rolagem = i;
+    int escala = arg2 ? atoi(arg2) : 0;
+    int limite = modo == TELA_GYRO ? 250 : 2000;
+    if (arg1 && (modo < 0 || (arg2 && (escala < 1 || escala > limite)) || (arg3 && rolagem < 0))){
+        printf("Uso: tela <stats|acc|gyro> [escala: 1 a 2000 mg ou 1 a 250 dps] [hw|2d|sw]\n");
+        return;
+    }
+    if (modo >= 0) grafico_cfg.modo = (uint8_t)modo;
+    if (arg2 && modo == TELA_ACC) grafico_cfg.escala_mg = (uint32_t)escala;
+    if (arg2 && modo == TELA_GYRO) grafico_cfg.escala_dps = (uint32_t)escala;
+    if (arg3) grafico_cfg.rolagem = (uint8_t)rolagem;
+    grafico_imprimir();
+}
+
+// Extensão do fluxo principal: só resumos (.res), binário ou CSV
+static const char *extensao(void){
+    if (resumo_s && resumo_so) return "res";
+    return formato_bin ? "bin" : "csv";
+}
+
+// Função para capturar dados e salvar no arquivo *.csv ou *.bin
 void generate_unique_filename(void) {
-    int index = 0;
-    FIL file;
-    FRESULT res;
-    do {
-        snprintf(filename, sizeof(filename), "log_%03d.csv", index++);
-        res = f_open(&file, filename, FA_READ);
-        if (res != FR_OK) break; // Arquivo não existe, pode usar
-        f_close(&file);
-    } while (index < 1000);
+    log_store_nome(filename, sizeof(filename), extensao());
+}
+
+// Setores entregues ao servidor de armazenamento e ainda não devolvidos ao pipeline
+static uint32_t setores_gravando;
+static bool falha_gravacao;
+
+// Callback de cada setor gravado pelo core1; o f_sync fica a cargo do log_commit
+static void setor_gravado(const storage_pedido_t *p){
+    if (p->res != FR_OK || p->n != p->len)
+        falha_gravacao = true;
+    else {
+        stats.bytes_gravados += p->n;
+        log_commit_gravado(p->fil);
+    }
+    pipeline_liberar_setor(p->ctx);
+    setores_gravando--;
+}
+
+// Incorpora ao erro da captura a falha relatada pelos callbacks, avisando uma vez
+static bool checar_falha(bool erro){
+    if (falha_gravacao && !erro) printf("[ERRO] Falha ao escrever no arquivo.\n");
+    return erro || falha_gravacao;
+}
+
+// Segmento aberto ou fechado pelo servidor de armazenamento; o core0 espera o resultado.
+// A proteção contra a rotação e a contabilidade do log_store ficam no core1, junto
+// dos passos de recuperação que rodam lá durante a captura
+typedef struct {
+    FIL *file;
+    const char *nome;
+    FSIZE_t reserva, tamanho;
+} segmento_pedido_t;
+
+static FRESULT segmento_abrir_srv(storage_pedido_t *p){
+    segmento_pedido_t *s = p->ctx;
+    FRESULT fr = f_open(s->file, s->nome, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK) return fr;
+    if (s->reserva && f_expand(s->file, s->reserva, 1) != FR_OK){
+        printf("[INFO] Sem área contígua para %s; alocação sob demanda.\n", s->nome);
+        s->reserva = 0;
+    }
+    log_store_manter(s->nome);
+    log_store_contabilizar((int64_t)s->reserva);
+    return FR_OK;
+}
+
+static FRESULT segmento_fechar_srv(storage_pedido_t *p){
+    segmento_pedido_t *s = p->ctx;
+    FRESULT fr = f_truncate(s->file);
+    FSIZE_t tamanho = f_size(s->file);
+    FRESULT fc = f_close(s->file);
+    log_store_contabilizar((int64_t)tamanho - (int64_t)s->reserva);
+    log_store_soltar(s->nome);
+    return fr != FR_OK ? fr : fc;
+}
+
+// Abre um segmento e reserva área contígua para ele, de modo que as gravações
+// seguintes não precisem alocar clusters nem atualizar a FAT
+static bool segmento_abrir(FIL *file, const char *nome, FSIZE_t reserva, FSIZE_t *reservado){
+    segmento_pedido_t s = {.file = file, .nome = nome, .reserva = reserva};
+    *reservado = 0;
+    if (storage_chamar(segmento_abrir_srv, &s) != FR_OK) return false;
+    *reservado = s.reserva;
+    return true;
+}
+
+// Descarta a reserva que sobrou além do último byte gravado e fecha
+static void segmento_fechar(FIL *file, const char *nome, FSIZE_t reservado){
+    segmento_pedido_t s = {.file = file, .nome = nome, .reserva = reservado};
+    storage_chamar(segmento_fechar_srv, &s);
+}
+
+// Recuperação de logs antigos durante a captura: um passo por vez no servidor,
+// enquanto o core0 espera setores. Quando o passo não acha o que liberar, a
+// próxima tentativa fica para depois de MANUTENCAO_MS
+static bool recuperar_pendente;
+static uint32_t recuperar_apos;
+
+static FRESULT recuperar_srv(storage_pedido_t *p){
+    p->n = log_store_recuperar_passo();
+    return FR_OK;
+}
+
+static void recuperar_fim(const storage_pedido_t *p){
+    recuperar_pendente = false;
+    if (!p->n) recuperar_apos = to_ms_since_boot(get_absolute_time()) + MANUTENCAO_MS;
+}
+
+static void recuperar_em_fundo(void){
+    if (recuperar_pendente || (int32_t)(to_ms_since_boot(get_absolute_time()) - recuperar_apos) < 0) return;
+    recuperar_pendente = true;
+    storage_pedido_t p = {.op = STORAGE_CHAMAR, .fn = recuperar_srv, .cb = recuperar_fim};
+    storage_enviar(&p);
+}
+
+// Arquivos auxiliares da captura (resumos, espectro), um por tipo de registro
+static FIL aux_arq[PIPE_AUX_TIPOS];
+static char aux_nome[PIPE_AUX_TIPOS][20];
+static bool aux_aberto[PIPE_AUX_TIPOS];
+
+static void aux_abrir(pipe_aux_tipo_t tipo, const char *ext, const char *cabecalho){
+    log_store_nome(aux_nome[tipo], sizeof(aux_nome[tipo]), ext);
+    aux_aberto[tipo] = f_open(&aux_arq[tipo], aux_nome[tipo], FA_WRITE | FA_CREATE_ALWAYS) == FR_OK;
+    if (aux_aberto[tipo]){
+        char calib[CALIB_TXT_MAX];
+        if (calib_registro(calib, sizeof(calib))) f_puts(calib, &aux_arq[tipo]); // Resumos e espectro também saem de dados corrigidos
+        f_puts(cabecalho, &aux_arq[tipo]);
+        log_store_manter(aux_nome[tipo]); // Fora da sequência dos segmentos: a rotação não o toca
+    } else
+        printf("[ERRO] Não foi possível criar %s; seguindo sem ele.\n", aux_nome[tipo]);
+}
+
+// Grava os registros que o core1 deixou na fila auxiliar; confirma no ritmo do log_commit
+static void aux_escrever(bool confirmar){
+    static uint32_t ultimo_sync;
+    const pipe_aux_t *r;
+    bool escreveu = false;
+    while ((r = pipeline_proximo_aux())){
+        UINT bw;
+        if (aux_aberto[r->tipo] && f_write(&aux_arq[r->tipo], r->txt, r->len, &bw) == FR_OK) escreveu = true;
+        pipeline_liberar_aux();
+    }
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    if (confirmar || (escreveu && agora - ultimo_sync >= log_commit_periodo_ms())){
+        for (int t = 0; t < PIPE_AUX_TIPOS; t++)
+            if (aux_aberto[t]) f_sync(&aux_arq[t]);
+        ultimo_sync = agora;
+    }
+}
+
+static bool aux_pendente; // Pedido de gravação auxiliar na fila do servidor
+
+static FRESULT aux_gravar_srv(storage_pedido_t *p){
+    aux_escrever(false);
+    return FR_OK;
+}
+
+static void aux_gravado(const storage_pedido_t *p){
+    aux_pendente = false;
+}
+
+// Durante a captura: os registros vão ao cartão pelo servidor, um pedido por vez
+static void aux_gravar(void){
+    if (aux_pendente || !pipeline_proximo_aux()) return;
+    aux_pendente = true;
+    storage_pedido_t p = {.op = STORAGE_CHAMAR, .fn = aux_gravar_srv, .cb = aux_gravado};
+    storage_enviar(&p);
+}
+
+// Depois da captura, com o servidor ocioso: o core0 pode chamar o FatFs direto
+static void aux_fechar(void){
+    aux_escrever(true);
+    for (int t = 0; t < PIPE_AUX_TIPOS; t++){
+        if (!aux_aberto[t]) continue;
+        log_store_contabilizar((int64_t)f_size(&aux_arq[t]));
+        f_close(&aux_arq[t]);
+        aux_aberto[t] = false;
+        printf("Registros auxiliares em %s.\n", aux_nome[t]);
+    }
 }
 
 void capture_data_and_save(void){
-    char buffer[80];
-    char header[] = "id,ax,ay,az,gx,gy,gz,temp\n";
+    static FIL arquivos[2]; // Segmento em gravação e o próximo, já aberto e reservado
+    static char proximo[20];
+    FSIZE_t reservado[2];
     printf("\nCapturando dados. Aguarde finalização...\n");
 
-    FIL file;
-    FRESULT res = f_open(&file, filename, FA_WRITE | FA_CREATE_ALWAYS);
-    if (res != FR_OK){
+    stats_reset();
+    // Com gatilho a captura vai até ser parada e cada evento vira um arquivo
+    bool continua = captura_continua || trigger_cfg.modo != TRIGGER_DESLIGADO;
+    bool bin = formato_bin && !(resumo_s && resumo_so); // Só resumos: o fluxo principal é texto
+    FSIZE_t reserva = continua ? (FSIZE_t)segmento_mib << 20 : 0;
+    int atual = 0;
+    bool proximo_aberto = false;
+    if (!segmento_abrir(&arquivos[atual], filename, reserva, &reservado[atual])){
         printf("\n[ERRO] Não foi possível abrir o arquivo para escrita. Monte o cartão.\n");
         return;
     }
-    // Escreve cabeçalho
-    UINT bw;
-    res = f_write(&file, header, strlen(header), &bw);
-    if (res != FR_OK){
-        printf("[ERRO] Falha ao escrever cabeçalho.\n");
-        f_close(&file);
-        return;
+    // O f_expand varre a FAT sem limite de tempo: só antes da amostragem começar.
+    // O primeiro e o segundo segmento saem reservados; os seguintes, abertos com
+    // a captura em curso, alocam sob demanda
+    if (continua){
+        log_store_nome(proximo, sizeof(proximo), extensao());
+        proximo_aberto = segmento_abrir(&arquivos[atual ^ 1], proximo, reserva, &reservado[atual ^ 1]);
+    }
+    if (resumo_s && !resumo_so) aux_abrir(PIPE_AUX_RESUMO, "res", win_stats_cabecalho);
+    if (espectro_ativo()){
+        char cab[ESPECTRO_BANDAS_MAX * 16 + 8];
+        espectro_cabecalho(cab, sizeof(cab), 1000000u / pipeline_periodo_us(periodo_amostra_us)); // Bordas na taxa que o sensor vai entregar
+        aux_abrir(PIPE_AUX_ESPECTRO, "esp", cab);
     }
-    f_sync(&file);
 
-    for (int i = 0; i < 128; i++){
-        if (stop_capture) {
-            f_sync(&file);  // garante persistência
+    // Amostragem (ISR do timer no core0) e codificação (core1) correm em paralelo;
+    // aqui só chegam setores cheios, cabeçalho CSV incluído. Cada setor vai ao
+    // cartão só com f_write; metadados são confirmados pelo log_commit a cada período.
+    uint32_t sessao = log_commit_abrir(bin);
+    log_commit_segmento(&arquivos[atual], filename, proximo_aberto ? proximo : NULL);
+    if (continua)
+        pipeline_segmentar(segmento_mib << 20, segmento_min * (60000000u / periodo_amostra_us));
+    else
+        pipeline_segmentar(0, 0);
+    uint32_t resumo_n = resumo_s * (1000000u / periodo_amostra_us);
+    if (resumo_n > WIN_STATS_MAX){ // Taxa trocada depois do 'resumo': o pipeline cortaria a janela calado
+        printf("[AVISO] Resumo de %lu s passa de %lu amostras a esta taxa; janela cortada em %lu amostras.\n",
+               (unsigned long)resumo_s, (unsigned long)WIN_STATS_MAX, (unsigned long)WIN_STATS_MAX);
+        resumo_n = WIN_STATS_MAX;
+    }
+    pipeline_resumo(resumo_n, resumo_so);
+    // Com a amostragem em curso nem o truncamento de um segmento nem a recuperação de
+    // logs antigos mandam TRIM ao cartão: o CMD38 prende o volume por até 2 s e a
+    // fila de amostras transbordaria
+    sd_set_trim_enabled(false);
+    pipeline_iniciar(bin, sessao, periodo_amostra_us, continua ? 0 : 128);
+    bool parado = false, erro = false;
+    setores_gravando = 0;
+    falha_gravacao = false;
+    recuperar_apos = to_ms_since_boot(get_absolute_time());
+    capturas++;
+    uint32_t inicio_iter = time_us_32(), espera = 0, ultima_telemetria = inicio_iter;
+    stats_publicar(); // A página não começa com os números da captura anterior
+    while (true){
+        // Carga do core0: a volta anterior menos o tempo parado à espera de setores
+        uint32_t agora = time_us_32();
+        stats_ocupado(agora - inicio_iter - espera);
+        inicio_iter = agora;
+        espera = 0;
+        if (agora - ultima_telemetria >= 100 * 1000){ // No ritmo do redesenho da página de estatísticas
+            stats_publicar();
+            ultima_telemetria = agora;
+        }
+        if (stop_capture && !parado) {
+            pipeline_parar();
+            parado = true;
             printf("\n[INFO] Captura interrompida pelo usuário.\n");
-            break;
         }
-
-        mpu6050_read_raw(acceleration, gyro, &temp);
-
-        float temperature = (temp / 340.0f) + 36.53f;
-        int len = sprintf(buffer, "%d,%ld,%ld,%ld,%ld,%ld,%ld,%.1f\n",
-                          i + 1,
-                          acceleration[0], acceleration[1], acceleration[2],
-                          gyro[0], gyro[1], gyro[2],
-                          temperature);
-
-        res = f_write(&file, buffer, len, &bw);
-        if (res != FR_OK){
-            printf("[ERRO] Falha ao escrever no arquivo.\n");
-            break;
+        pipe_setor_t *setor;
+        bool ultimo;
+        storage_concluir();
+        erro = checar_falha(erro);
+        aux_gravar();
+        // Com setores no core1 o prazo é curto: cada um volta ao pipeline pelo callback
+        uint32_t t = time_us_32();
+        bool chegou = pipeline_proximo_setor(setores_gravando ? 1000 : 10 * 1000, &setor, &ultimo);
+        espera = time_us_32() - t;
+        if (!chegou){
+            // Tempo ocioso: prepara o próximo segmento antes de ele ser necessário
+            if (continua && !proximo_aberto && !erro){
+                log_store_nome(proximo, sizeof(proximo), extensao());
+                proximo_aberto = segmento_abrir(&arquivos[atual ^ 1], proximo, 0, &reservado[atual ^ 1]);
+                if (proximo_aberto) log_commit_segmento(&arquivos[atual], filename, proximo);
+            }
+            // Capturas longas passam da cota: os logs antigos vão sendo liberados também aqui
+            if (!erro) recuperar_em_fundo();
+            continue;
         }
-
-        f_sync(&file);  // opcional: garante gravação a cada iteração
-        sleep_ms(100);
+        bool fim_segmento = setor->fim_segmento;
+        if (!erro && setor->len > 0){
+            // O core1 grava; o setor volta ao pipeline no callback
+            setores_gravando++;
+            storage_anexar(&arquivos[atual], setor->dados, setor->len, setor_gravado, setor);
+        } else
+            pipeline_liberar_setor(setor);
+        if (fim_segmento && !erro){
+            uint32_t t = time_us_32();
+            storage_esperar(); // O segmento inteiro no cartão antes de confirmá-lo e fechá-lo
+            espera += time_us_32() - t;
+            erro = checar_falha(erro);
+        }
+        if (fim_segmento && !erro){
+            if (!proximo_aberto){
+                log_store_nome(proximo, sizeof(proximo), extensao());
+                proximo_aberto = segmento_abrir(&arquivos[atual ^ 1], proximo, 0, &reservado[atual ^ 1]);
+            }
+            if (proximo_aberto){
+                // Confirma o segmento inteiro antes de fechá-lo; o novo entra no registro logo em seguida
+                log_commit_segmento(&arquivos[atual], filename, proximo);
+                segmento_fechar(&arquivos[atual], filename, reservado[atual]);
+                printf("[INFO] Segmento %s fechado; gravando em %s.\n", filename, proximo);
+                snprintf(filename, sizeof(filename), "%s", proximo);
+                atual ^= 1;
+                proximo_aberto = false;
+                log_commit_segmento(&arquivos[atual], filename, NULL);
+            } else {
+                printf("[ERRO] Não foi possível abrir o próximo segmento.\n");
+                erro = true;
+            }
+        }
+        if (erro && !parado){
+            pipeline_parar();
+            parado = true;
+        }
+        if (ultimo) break;
     }
-
-    f_close(&file);
+    pipeline_parar(); // Solta o relógio de amostragem também quando a captura acaba sozinha
+    storage_esperar();
+    sd_set_trim_enabled(true);
+    checar_falha(erro);
+    aux_fechar();
+
+    segmento_fechar(&arquivos[atual], filename, reservado[atual]);
+    if (proximo_aberto){
+        f_close(&arquivos[atual ^ 1]); // Reserva que não chegou a ser usada
+        if (f_unlink(proximo) == FR_OK) log_store_contabilizar(-(int64_t)reservado[atual ^ 1]);
+    }
+    log_store_manter(NULL);
+    log_commit_fechar();
     printf("\nDados %s no arquivo %s.\n\n",
            stop_capture ? "parciais salvos" : "completos salvos",
            filename);
@@ -754,24 +1268,24 @@ void capture_data_and_save(void){
     stop_capture = false;  // reset para próxima captura
 }
 
-// Função para ler o conteúdo de um arquivo e exibir no terminal
-void read_file(const char *filename){
-    FIL file;
-    FRESULT res = f_open(&file, filename, FA_READ);
-    if (res != FR_OK){
+static void read_file_fim(const storage_pedido_t *p){
+    if (FR_OK != p->res)
         printf("[ERRO] Não foi possível abrir o arquivo para leitura. Verifique se o Cartão está montado ou se o arquivo existe.\n");
+    else
+        printf("\nLeitura do arquivo %s concluída.\n\n", p->nome);
+    shell_fechar(p);
+}
 
-        return;
-    }
-    char buffer[128];
-    UINT br;
+// Função para ler o conteúdo de um arquivo e exibir no terminal (pelo servidor de armazenamento)
+void read_file(const char *filename){
+    storage_pedido_t p = {.op = STORAGE_MOSTRAR};
+    snprintf(p.nome, sizeof(p.nome), "%s", filename);
     printf("Conteúdo do arquivo %s:\n", filename);
-    while (f_read(&file, buffer, sizeof(buffer) - 1, &br) == FR_OK && br > 0){
-        buffer[br] = '\0';
-        printf("%s", buffer);
-    }
-    f_close(&file);
-    printf("\nLeitura do arquivo %s concluída.\n\n", filename);
+    shell_enviar(&p, read_file_fim);
+}
+
+static void run_ultimo(void){
+    read_file(filename);
 }
 
 static void run_help(void){
@@ -819,6 +1333,10 @@ static void process_stdio(int cRxedChar){
         }
         ix = 0;
         memset(cmd, 0, sizeof cmd);
+        if (prompt_adiado){ // A saída ainda vem do core1; o callback imprime o prompt
+            prompt_adiado = false;
+            return;
+        }
         printf("\n> ");
         stdio_flush();
     } else {
@@ -835,32 +1353,3 @@ static void process_stdio(int cRxedChar){
         }
     }
 }
-    
-static void mpu6050_reset(void){
-    uint8_t buf[] = {0x6B, 0x80};
-    i2c_write_blocking(i2c_port, addr, buf, 2, false);
-    sleep_ms(100);
-    buf[1] = 0x00;
-    i2c_write_blocking(i2c_port, addr, buf, 2, false);
-    sleep_ms(10);
-}
-
-static void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp){
-    uint8_t buffer[6];
-    uint8_t val = 0x3B;
-    i2c_write_blocking(i2c_port, addr, &val, 1, true);
-    i2c_read_blocking(i2c_port, addr, buffer, 6, false);
-    for (int i = 0; i < 3; i++)
-        accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
-
-    val = 0x43;
-    i2c_write_blocking(i2c_port, addr, &val, 1, true);
-    i2c_read_blocking(i2c_port, addr, buffer, 6, false);
-    for (int i = 0; i < 3; i++)
-        gyro[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
-
-    val = 0x41;
-    i2c_write_blocking(i2c_port, addr, &val, 1, true);
-    i2c_read_blocking(i2c_port, addr, buffer, 2, false);
-    *temp = (buffer[0] << 8) | buffer[1];
-}
\ No newline at end of file
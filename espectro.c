@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include "lib/espectro.h"
+#include "lib/fft_q15.h"
+#include "lib/csv_fmt.h"
+
+static uint32_t pontos, bandas = 8;
+static int16_t janela[3][FFT_Q15_MAX]; // Eixos x, y, z da janela em preenchimento
+static fft_q15_c_t bins[FFT_Q15_MAX / 2 + 1];
+static uint32_t cheio, id0, ultimo_id0;
+static uint32_t banda_ug[ESPECTRO_BANDAS_MAX];
+
+void espectro_config(uint32_t n, uint32_t b){
+    pontos = n;
+    bandas = b < 1 ? 1 : b > ESPECTRO_BANDAS_MAX ? ESPECTRO_BANDAS_MAX : b;
+    if (bandas > n / 2 - 1) bandas = n ? n / 2 - 1 : bandas;
+}
+
+bool espectro_ativo(void){
+    return pontos != 0;
+}
+
+void espectro_imprimir(void){
+    if (pontos)
+        printf("Espectro: janelas de %lu pontos (Hann), %lu bandas\n", (unsigned long)pontos, (unsigned long)bandas);
+    else
+        printf("Espectro desligado\n");
+}
+
+// Primeiro bin da banda b; a banda vai até o primeiro bin da seguinte (exclusive)
+static uint32_t banda_inicio(uint32_t b){
+    return 1 + b * (pontos / 2 - 1) / bandas;
+}
+
+size_t espectro_cabecalho(char *dst, size_t tam, uint32_t hz){
+    size_t n = (size_t)snprintf(dst, tam, "id0");
+    for (uint32_t b = 0; b < bandas && n < tam; b++)
+        n += (size_t)snprintf(dst + n, tam - n, ",ug_%lu_%lu",
+                              (unsigned long)(banda_inicio(b) * hz / pontos),
+                              (unsigned long)(banda_inicio(b + 1) * hz / pontos));
+    if (n < tam) n += (size_t)snprintf(dst + n, tam - n, "\n");
+    return n < tam ? n : tam - 1;
+}
+
+void espectro_reiniciar(void){
+    cheio = 0;
+    for (uint32_t b = 0; b < ESPECTRO_BANDAS_MAX; b++) banda_ug[b] = 0;
+}
+
+static uint32_t raiz64(uint64_t x){
+    uint64_t r = 0;
+    for (uint64_t bit = 1ull << 62; bit; bit >>= 2){
+        if (x >= r + bit){
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return (uint32_t)r;
+}
+
+// Tira a média e amplia o eixo até perto da escala cheia; retorna o deslocamento usado
+static int normalizar(int16_t *x){
+    int32_t soma = 0;
+    for (uint32_t i = 0; i < pontos; i++) soma += x[i];
+    int32_t media = soma / (int32_t)pontos;
+    int32_t maior = 0;
+    for (uint32_t i = 0; i < pontos; i++){
+        int32_t v = x[i] - media;
+        if (v > 32767) v = 32767;
+        if (v < -32768) v = -32768;
+        x[i] = (int16_t)v;
+        if (v < 0) v = -v;
+        if (v > maior) maior = v;
+    }
+    if (!maior) return -1;
+    int s = __builtin_clz((uint32_t)maior) - 17; // Maior valor passa a ocupar o bit 14
+    if (s < 0) s = 0;
+    for (uint32_t i = 0; i < pontos; i++) x[i] = (int16_t)(x[i] << s);
+    return s;
+}
+
+#define ESCALA 8 // Potências acumuladas em escala 2^(2·ESCALA), comum aos três eixos
+
+static void processar(void){
+    static uint64_t energia[ESPECTRO_BANDAS_MAX];
+    for (uint32_t b = 0; b < bandas; b++) energia[b] = 0;
+    for (int eixo = 0; eixo < 3; eixo++){
+        int s = normalizar(janela[eixo]);
+        if (s < 0) continue; // Eixo constante: nenhuma energia
+        fft_q15_hann(janela[eixo], pontos);
+        fft_q15_real(janela[eixo], pontos, bins);
+        for (uint32_t b = 0; b < bandas; b++){
+            uint64_t e = 0;
+            for (uint32_t k = banda_inicio(b); k < banda_inicio(b + 1); k++)
+                e += (uint32_t)(bins[k].re * bins[k].re) + (uint32_t)(bins[k].im * bins[k].im);
+            energia[b] += s <= ESCALA ? e << (2 * (ESCALA - s)) : e >> (2 * (s - ESCALA));
+        }
+    }
+    for (uint32_t b = 0; b < bandas; b++){
+        // Média quadrática unilateral = 2·Σ|X/n|², corrigida pelo ganho de energia da Hann (3/8)
+        uint32_t rms = raiz64(energia[b] * 16 / 3);      // Em LSB · 2^ESCALA
+        banda_ug[b] = (uint32_t)(((uint64_t)rms * 15625) >> (8 + ESCALA)); // 1 LSB = 10^6/16384 µg
+    }
+}
+
+bool espectro_amostra(const amostra_t *a){
+    if (!pontos) return false;
+    if (!cheio) id0 = a->id;
+    for (int eixo = 0; eixo < 3; eixo++) janela[eixo][cheio] = a->canais[eixo];
+    if (++cheio < pontos) return false;
+    processar();
+    ultimo_id0 = id0;
+    cheio = 0;
+    return true;
+}
+
+size_t espectro_registro(char *dst){
+    char *p = csv_fmt_u32(dst, ultimo_id0);
+    for (uint32_t b = 0; b < bandas; b++){
+        *p++ = ',';
+        p = csv_fmt_u32(p, banda_ug[b]);
+    }
+    *p++ = '\n';
+    return (size_t)(p - dst);
+}
+
+void espectro_desenhar(ssd1306_t *ssd, uint8_t y0, uint8_t altura){
+    uint8_t largura = (uint8_t)(128 / bandas);
+    for (uint32_t b = 0; b < bandas; b++){
+        // Escala log2: cada pixel dobra a amplitude, a partir de ~1 mg
+        uint32_t v = banda_ug[b] >> 10;
+        uint8_t h = v ? (uint8_t)(32 - __builtin_clz(v)) : 0;
+        if (h > altura) h = altura;
+        uint8_t x = (uint8_t)(b * largura);
+        ssd1306_rect(ssd, y0, x, largura, altura, false, true);
+        if (h) ssd1306_rect(ssd, (uint8_t)(y0 + altura - h), x, (uint8_t)(largura - 1), h, true, true);
+    }
+}
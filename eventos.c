@@ -0,0 +1,55 @@
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "lib/eventos.h"
+
+// Um tipo pendente por bit: a fila cabe em EVENTO_TIPOS posições. Todas as
+// fontes são ISRs do core0, então basta mascarar interrupções ao mexer nela.
+static evento_t fila[EVENTO_TIPOS];
+static uint32_t cabeca, cauda;
+static volatile uint32_t pendentes;
+static alarm_id_t alarme;
+
+static void serial_chegou(void *param){
+    eventos_publicar(EVENTO_SERIAL);
+}
+
+static int64_t prazo(alarm_id_t id, void *param){
+    alarme = 0;
+    eventos_publicar(EVENTO_TEMPO);
+    return 0;
+}
+
+void eventos_iniciar(void){
+    stdio_set_chars_available_callback(serial_chegou, NULL);
+    eventos_publicar(EVENTO_TEMPO); // Primeira rodada de manutenção
+    eventos_publicar(EVENTO_SERIAL); // O que chegou antes do callback
+}
+
+void eventos_publicar(evento_t e){
+    uint32_t s = save_and_disable_interrupts();
+    if (!(pendentes & (1u << e))){
+        pendentes |= 1u << e;
+        fila[cabeca++ % EVENTO_TIPOS] = e;
+    }
+    restore_interrupts(s);
+    __sev(); // O laço pode estar entre o teste e o __wfe
+}
+
+bool eventos_proximo(evento_t *e){
+    if (!pendentes) return false;
+    uint32_t s = save_and_disable_interrupts();
+    *e = fila[cauda++ % EVENTO_TIPOS];
+    pendentes &= ~(1u << *e); // Nova ocorrência a partir daqui entra de novo
+    restore_interrupts(s);
+    return true;
+}
+
+bool eventos_pendentes(void){
+    return pendentes != 0;
+}
+
+void eventos_agendar(uint32_t ms){
+    if (alarme) cancel_alarm(alarme);
+    alarme = ms ? add_alarm_in_ms(ms, prazo, NULL, true) : 0;
+    if (alarme < 0) alarme = 0;
+}
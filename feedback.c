@@ -0,0 +1,129 @@
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "hardware/structs/clocks.h"
+#include "lib/feedback.h"
+
+#define RAMPA_PASSOS 100 // Degraus de cada subida ou descida
+#define PAUSA_MS 100     // Silêncio depois de cada bipe
+
+// Um trecho vai de 'de' a 'para' em passos + 1 degraus, cada um mantido por passo_us
+typedef struct {
+    uint16_t de, para;
+    uint16_t passos;
+    uint32_t passo_us;
+} trecho_t;
+
+static uint pino_buzzer, pinos[3];
+static trecho_t fila[FEEDBACK_TRECHOS];
+static uint32_t cabeca, cauda;   // Alterados com interrupções mascaradas
+static trecho_t atual;
+static uint32_t degrau;          // Próximo degrau de 'atual'; > passos quando acabou
+static volatile alarm_id_t som;  // Alarme do buzzer (0 = parado)
+static alarm_id_t pisca;
+static uint8_t cores_atuais;
+static bool aceso;
+static uint32_t pisca_us;
+
+static void leds(uint8_t cores){
+    for (int i = 0; i < 3; i++) gpio_put(pinos[i], (cores >> i) & 1);
+}
+
+// O PWM perde o relógio quando os dois cores dormem (power_iniciar): só o mantém enquanto toca
+static void relogio_pwm(bool ligado){
+    if (ligado)
+        hw_set_bits(&clocks_hw->sleep_en0, CLOCKS_SLEEP_EN0_CLK_SYS_PWM_BITS);
+    else
+        hw_clear_bits(&clocks_hw->sleep_en0, CLOCKS_SLEEP_EN0_CLK_SYS_PWM_BITS);
+}
+
+static int64_t tocar(alarm_id_t id, void *param){
+    if (degrau > atual.passos){
+        if (cauda == cabeca){
+            som = 0;
+            relogio_pwm(atual.para != 0); // Nível final alto segue soando
+            return 0;
+        }
+        atual = fila[cauda++ & (FEEDBACK_TRECHOS - 1)];
+        degrau = 0;
+    }
+    uint32_t nivel = atual.passos
+        ? atual.de + ((int32_t)atual.para - (int32_t)atual.de) * (int32_t)degrau / atual.passos
+        : atual.para;
+    pwm_set_gpio_level(pino_buzzer, (uint16_t)nivel);
+    degrau++;
+    return -(int64_t)atual.passo_us; // Relativo ao disparo anterior: a rampa não acumula atraso
+}
+
+static int64_t piscar(alarm_id_t id, void *param){
+    aceso = !aceso;
+    leds(aceso ? cores_atuais : 0);
+    return -(int64_t)pisca_us;
+}
+
+void feedback_iniciar(uint buzzer, uint verde, uint azul, uint vermelho){
+    pino_buzzer = buzzer;
+    pinos[0] = verde;
+    pinos[1] = azul;
+    pinos[2] = vermelho;
+    gpio_set_function(buzzer, GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(buzzer);
+    pwm_set_clkdiv(slice, 32.0f);
+    pwm_set_wrap(slice, FEEDBACK_WRAP);
+    pwm_set_gpio_level(buzzer, 0);
+    pwm_set_enabled(slice, true);
+    degrau = 1; // Nada em 'atual'
+}
+
+// Com interrupções mascaradas; descarta o que não couber
+static void enfileirar(uint16_t de, uint16_t para, uint16_t passos, uint32_t ms){
+    if (cabeca - cauda >= FEEDBACK_TRECHOS) return;
+    uint32_t us = ms * 1000u / (passos + 1u);
+    fila[cabeca++ & (FEEDBACK_TRECHOS - 1)] = (trecho_t){de, para, passos, us ? us : 1};
+}
+
+void feedback_beep(float duty, uint8_t vezes, float seg, bool ramp, bool use_end, bool end_high){
+    uint16_t pico = (uint16_t)(duty * FEEDBACK_WRAP);
+    uint32_t total_ms = (uint32_t)(seg * 1000.0f);
+    uint32_t fase_ms = ramp ? total_ms / 2 : total_ms;
+    uint32_t s = save_and_disable_interrupts();
+    if (vezes == 0 && !ramp)
+        enfileirar(pico, pico, 0, 1); // Tom contínuo até o próximo padrão
+    else for (int t = 0; t < (vezes ? vezes : 1); t++){
+        if (ramp){
+            enfileirar(0, pico, RAMPA_PASSOS, fase_ms);
+            enfileirar(pico, 0, RAMPA_PASSOS, fase_ms);
+            if (use_end){
+                if (end_high) enfileirar(0, pico, RAMPA_PASSOS, fase_ms); // Termina no pico
+                break;
+            }
+        } else
+            enfileirar(pico, pico, 0, total_ms);
+        enfileirar(0, 0, 0, PAUSA_MS);
+    }
+    if (!som && cabeca != cauda){
+        relogio_pwm(true);
+        som = add_alarm_in_us(10, tocar, NULL, true);
+        if (som < 0) som = 0;
+    }
+    restore_interrupts(s);
+}
+
+void feedback_leds(uint8_t cores, uint32_t piscar_ms){
+    if (pisca){
+        cancel_alarm(pisca);
+        pisca = 0;
+    }
+    cores_atuais = cores;
+    aceso = true;
+    leds(cores);
+    if (piscar_ms && cores){
+        pisca_us = piscar_ms * 1000u;
+        pisca = add_alarm_in_us(pisca_us, piscar, NULL, true);
+        if (pisca < 0) pisca = 0;
+    }
+}
+
+bool feedback_tocando(void){
+    return som != 0;
+}
@@ -0,0 +1,93 @@
+#include "lib/fft_q15.h"
+
+// Quarto de onda do seno: sen(π/2 · k/128) em Q15, k = 0..128
+static const int16_t seno_q[129] = {
+    0, 402, 804, 1206, 1608, 2009, 2411, 2811, 3212, 3612, 4011, 4410,
+    4808, 5205, 5602, 5998, 6393, 6787, 7180, 7571, 7962, 8351, 8740, 9127,
+    9512, 9896, 10279, 10660, 11039, 11417, 11793, 12167, 12540, 12910, 13279, 13646,
+    14010, 14373, 14733, 15091, 15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+    18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475, 20788, 21097, 21403, 21706,
+    22006, 22302, 22595, 22884, 23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+    25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020, 27246, 27467, 27684, 27897,
+    28106, 28311, 28511, 28707, 28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+    30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238, 31357, 31471, 31581, 31686,
+    31786, 31881, 31972, 32058, 32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+    32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766, 32767};
+
+// Seno de 2πk / FFT_Q15_MAX por simetria do quarto de onda
+static int16_t seno(uint32_t k){
+    k &= FFT_Q15_MAX - 1;
+    uint32_t q = k >> 7, r = k & 127;
+    switch (q){
+        case 0: return seno_q[r];
+        case 1: return seno_q[128 - r];
+        case 2: return (int16_t)-seno_q[r];
+        default: return (int16_t)-seno_q[128 - r];
+    }
+}
+
+int16_t fft_q15_cos(uint32_t k){
+    return seno(k + FFT_Q15_MAX / 4);
+}
+
+static inline int16_t mul_q15(int32_t a, int32_t b){
+    return (int16_t)((a * b + 0x4000) >> 15);
+}
+
+void fft_q15_hann(int16_t *x, uint32_t n){
+    // w[i] = (1 - cos(2πi/n)) / 2
+    uint32_t passo = FFT_Q15_MAX / n;
+    for (uint32_t i = 0; i < n; i++){
+        int32_t w = (32767 - fft_q15_cos(i * passo)) >> 1;
+        x[i] = mul_q15(x[i], w);
+    }
+}
+
+// FFT complexa in-place de m pontos, decimação no tempo, escala 1/m
+static void fft_complexa(fft_q15_c_t *z, uint32_t m){
+    for (uint32_t i = 1, j = 0; i < m; i++){
+        uint32_t bit = m >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j){
+            fft_q15_c_t t = z[i];
+            z[i] = z[j];
+            z[j] = t;
+        }
+    }
+    for (uint32_t len = 2; len <= m; len <<= 1){
+        uint32_t meio = len >> 1, passo = FFT_Q15_MAX / len;
+        for (uint32_t j = 0; j < meio; j++){
+            // W = exp(-2πij/len)
+            int32_t wr = fft_q15_cos(j * passo), wi = -seno(j * passo);
+            for (uint32_t i = j; i < m; i += len){
+                fft_q15_c_t *a = &z[i], *b = &z[i + meio];
+                int32_t tr = (b->re * wr - b->im * wi + 0x4000) >> 15;
+                int32_t ti = (b->re * wi + b->im * wr + 0x4000) >> 15;
+                int32_t ar = a->re, ai = a->im;
+                a->re = (int16_t)((ar + tr) >> 1);
+                a->im = (int16_t)((ai + ti) >> 1);
+                b->re = (int16_t)((ar - tr) >> 1);
+                b->im = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+void fft_q15_real(int16_t *x, uint32_t n, fft_q15_c_t *saida){
+    // Pares (x[2k], x[2k+1]) viram um sinal complexo de n/2 pontos: metade do trabalho
+    uint32_t m = n >> 1, passo = FFT_Q15_MAX / n;
+    fft_q15_c_t *z = (fft_q15_c_t *)x;
+    fft_complexa(z, m);
+    // X[k] = (A + W·D) / 4 com A = Z[k] + conj(Z[m-k]), D = -i(Z[k] - conj(Z[m-k])), W = exp(-2πik/n)
+    for (uint32_t k = 0; k <= m; k++){
+        const fft_q15_c_t *zk = &z[k & (m - 1)], *zc = &z[(m - k) & (m - 1)];
+        int32_t ar = (zk->re + zc->re) >> 1, ai = (zk->im - zc->im) >> 1;
+        int32_t dr = (zk->im + zc->im) >> 1, di = -((zk->re - zc->re) >> 1);
+        int32_t wr = fft_q15_cos(k * passo), wi = -seno(k * passo);
+        int32_t pr = (dr * wr - di * wi + 0x4000) >> 15;
+        int32_t pi = (dr * wi + di * wr + 0x4000) >> 15;
+        saida[k].re = (int16_t)((ar + pr) >> 1);
+        saida[k].im = (int16_t)((ai + pi) >> 1);
+    }
+}
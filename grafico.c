@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "lib/grafico.h"
+
+#define PAGINA_TOPO 1        // A página 0 guarda o rótulo, que não rola
+#define PAGINA_FIM 6
+#define FAIXA 16             // Pixels por eixo
+#define X_NOVA (WIDTH - 1)   // Coluna onde entra o dado novo
+#define ACC_LSB_G 16384      // ±2 g, já calibrado
+#define GYRO_LSB_DPS 131     // ±250 °/s
+
+grafico_cfg_t grafico_cfg = {
+    .modo = TELA_STATS,
+    .escala_mg = 2000,
+    .escala_dps = 250,
+    .rolagem = ROLAGEM_CONTINUA};
+
+typedef struct {
+    int16_t min[MPU6050_CANAIS - 1], max[MPU6050_CANAIS - 1]; // ax..gz
+} coluna_t;
+
+static volatile uint8_t tela;        // Escrita pela ISR do botão, lida pelo core1
+// Exclusivos do core1 enquanto a captura está ativa
+static uint8_t desenhada;            // Tela que está no painel
+static uint32_t por_coluna, contagem;
+static coluna_t acum;
+static coluna_t colunas[GRAFICO_COLUNAS];
+static uint32_t cabeca, cauda;
+static uint32_t ultima_us, desenhadas;
+
+const char *const grafico_telas[TELA_MODOS] = {"stats", "acc", "gyro"};
+const char *const grafico_rolagens[ROLAGEM_MODOS] = {"hw", "2d", "sw"};
+static const char *const descricao_rolagem[ROLAGEM_MODOS] = {"contínua do painel", "de uma coluna do painel (0x2D)", "no buffer"};
+
+void grafico_imprimir(void){
+    printf("Tela da captura: %s; gráfico com fundo de escala %lu mg e %lu dps, rolagem %s (%s)\n",
+           grafico_telas[grafico_cfg.modo], (unsigned long)grafico_cfg.escala_mg,
+           (unsigned long)grafico_cfg.escala_dps, descricao_rolagem[grafico_cfg.rolagem],
+           grafico_rolagens[grafico_cfg.rolagem]);
+}
+
+void grafico_reiniciar(uint32_t periodo_us){
+    uint32_t hz = 1000000u / periodo_us;
+    por_coluna = hz * GRAFICO_COLUNA_MS / 1000;
+    if (!por_coluna) por_coluna = 1; // Taxas baixas: uma coluna por amostra
+    contagem = 0;
+    cabeca = cauda = 0;
+    tela = grafico_cfg.modo;
+    desenhada = TELA_MODOS; // Força o primeiro desenho
+}
+
+void grafico_amostra(const amostra_t *a){
+    for (int i = 0; i < MPU6050_CANAIS - 1; i++){
+        int16_t v = a->canais[i];
+        if (!contagem || v < acum.min[i]) acum.min[i] = v;
+        if (!contagem || v > acum.max[i]) acum.max[i] = v;
+    }
+    if (++contagem < por_coluna) return;
+    contagem = 0;
+    if (cabeca - cauda < GRAFICO_COLUNAS) colunas[cabeca++ & (GRAFICO_COLUNAS - 1)] = acum; // Cheia: o painel não acompanha, descarta
+}
+
+void grafico_trocar(void){
+    tela = (uint8_t)((tela + 1) % TELA_MODOS);
+}
+
+tela_modo_t grafico_tela(void){
+    return (tela_modo_t)tela;
+}
+
+// Linha da faixa do eixo para o valor v, com fundo de escala em LSB
+static uint8_t linha(int eixo, int32_t v, int32_t escala){
+    int32_t px = v * (FAIXA / 2) / escala;
+    if (px > FAIXA / 2 - 1) px = FAIXA / 2 - 1;
+    if (px < -FAIXA / 2) px = -FAIXA / 2;
+    return (uint8_t)(PAGINA_TOPO * 8 + eixo * FAIXA + FAIXA / 2 - 1 - px);
+}
+
+static void coluna_desenhar(ssd1306_t *ssd, const coluna_t *c, uint8_t modo){
+    int base = modo == TELA_ACC ? 0 : 3;
+    int32_t escala = modo == TELA_ACC ? (int32_t)(grafico_cfg.escala_mg * ACC_LSB_G / 1000)
+                                      : (int32_t)(grafico_cfg.escala_dps * GYRO_LSB_DPS);
+    if (escala < 1) escala = 1;
+    ssd1306_vline(ssd, X_NOVA, PAGINA_TOPO * 8, PAGINA_FIM * 8 + 7, false);
+    for (int e = 0; e < 3; e++){
+        if (!(desenhadas & 3)) ssd1306_pixel(ssd, X_NOVA, linha(e, 0, escala), true); // Zero pontilhado
+        ssd1306_vline(ssd, X_NOVA, linha(e, c->max[base + e], escala), linha(e, c->min[base + e], escala), true);
+    }
+    desenhadas++;
+}
+
+void grafico_parar(ssd1306_t *ssd){
+    ssd1306_scroll_stop(ssd, (time_us_32() - ultima_us) / 1000);
+}
+
+bool grafico_desenhar(ssd1306_t *ssd){
+    uint8_t t = tela;
+    if (t != desenhada){
+        grafico_parar(ssd);
+        desenhada = t;
+        cauda = cabeca; // Colunas de antes da troca não entram
+        if (t == TELA_STATS) return false; // A página de estatísticas é do chamador
+        char rotulo[16];
+        snprintf(rotulo, sizeof(rotulo), "%s %lu%s xyz", grafico_telas[t],
+                 (unsigned long)(t == TELA_ACC ? grafico_cfg.escala_mg : grafico_cfg.escala_dps),
+                 t == TELA_ACC ? "mg" : "dps");
+        ssd1306_fill(ssd, false);
+        ssd1306_draw_string(ssd, rotulo, 0, 0);
+        ssd1306_flush_dirty(ssd);
+        ultima_us = time_us_32();
+        return true;
+    }
+    if (t == TELA_STATS || time_us_32() - ultima_us < GRAFICO_COLUNA_MS * 1000) return false;
+    // O painel deu o passo da coluna anterior: para antes de escrever, mesmo sem coluna nova,
+    // para não dar o segundo
+    bool parou = ssd->scrolling;
+    grafico_parar(ssd);
+    if (cauda == cabeca) return parou;
+    coluna_t c = colunas[cauda++ & (GRAFICO_COLUNAS - 1)];
+    if (grafico_cfg.rolagem != ROLAGEM_CONTINUA) // Na contínua o passo já foi dado pelo painel
+        ssd1306_scroll_left(ssd, PAGINA_TOPO, PAGINA_FIM, 0, X_NOVA, grafico_cfg.rolagem == ROLAGEM_COLUNA);
+    coluna_desenhar(ssd, &c, t);
+    if (grafico_cfg.rolagem == ROLAGEM_BUFFER)
+        ssd1306_flush_dirty(ssd);
+    else
+        ssd1306_send_window(ssd, X_NOVA, X_NOVA, PAGINA_TOPO, PAGINA_FIM); // O que o painel girou para cá não importa
+    if (grafico_cfg.rolagem == ROLAGEM_CONTINUA) ssd1306_scroll_start(ssd, PAGINA_TOPO, PAGINA_FIM);
+    ultima_us = time_us_32();
+    return true;
+}
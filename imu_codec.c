@@ -0,0 +1,129 @@
+#include <string.h>
+#include "lib/imu_codec.h"
+#include "crc.h"
+
+// Pior caso de uma amostra: 3 bytes de varint por canal (delta de 17 bits após o zigzag)
+#define VARINT_MAX 3
+
+static inline uint32_t zigzag(int32_t v){
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u){
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+void imu_codec_iniciar(imu_codec_t *c, uint8_t *bloco, uint8_t canais, uint32_t sessao, uint32_t seq, uint32_t id0){
+    imu_bloco_cab_t cab = {
+        .magic = IMU_BLOCO_MAGIC,
+        .versao = IMU_BLOCO_VERSAO,
+        .canais = canais,
+        .seq = seq,
+        .id0 = id0,
+        .sessao = sessao};
+    c->bloco = bloco;
+    c->canais = canais;
+    c->amostras = 0;
+    c->id0 = id0;
+    c->pos = sizeof(imu_bloco_cab_t);
+    memcpy(bloco, &cab, sizeof(cab));
+}
+
+// O cabeçalho só guarda id0: com uma lacuna na numeração o bloco precisa fechar
+bool imu_codec_continua(const imu_codec_t *c, uint32_t id){
+    return id == c->id0 + c->amostras;
+}
+
+bool imu_codec_adicionar(imu_codec_t *c, const int16_t *amostra){
+    uint8_t *p = c->bloco + c->pos;
+    if (c->amostras == 0){
+        // Primeira amostra do bloco vai crua, para o bloco ser decodificável sozinho
+        if (c->pos + 2u * c->canais > IMU_BLOCO_TAM) return false;
+        for (uint8_t i = 0; i < c->canais; i++){
+            *p++ = (uint8_t)amostra[i];
+            *p++ = (uint8_t)((uint16_t)amostra[i] >> 8);
+        }
+    } else {
+        uint8_t tmp[IMU_CANAIS_MAX * VARINT_MAX];
+        uint8_t *t = tmp;
+        for (uint8_t i = 0; i < c->canais; i++){
+            uint32_t u = zigzag((int32_t)amostra[i] - c->anterior[i]);
+            while (u >= 0x80){
+                *t++ = (uint8_t)(u | 0x80);
+                u >>= 7;
+            }
+            *t++ = (uint8_t)u;
+        }
+        size_t n = (size_t)(t - tmp);
+        if (c->pos + n > IMU_BLOCO_TAM) return false;
+        memcpy(p, tmp, n);
+        p += n;
+    }
+    memcpy(c->anterior, amostra, c->canais * sizeof(int16_t));
+    c->pos = (uint16_t)(p - c->bloco);
+    c->amostras++;
+    return true;
+}
+
+void imu_codec_finalizar(imu_codec_t *c){
+    imu_bloco_cab_t *cab = (imu_bloco_cab_t *)c->bloco;
+    cab->amostras = c->amostras;
+    cab->bytes = (uint16_t)(c->pos - sizeof(imu_bloco_cab_t));
+    memset(c->bloco + c->pos, 0, IMU_BLOCO_TAM - c->pos);
+    cab->crc = 0;
+    cab->crc = crc16((const char *)c->bloco, IMU_BLOCO_TAM);
+}
+
+void imu_codec_nota(uint8_t *bloco, uint32_t sessao, uint32_t seq, const char *txt, size_t len){
+    imu_codec_t c;
+    imu_codec_iniciar(&c, bloco, 0, sessao, seq, 0);
+    if (len > IMU_BLOCO_TAM - c.pos) len = IMU_BLOCO_TAM - c.pos;
+    memcpy(bloco + c.pos, txt, len);
+    c.pos += (uint16_t)len;
+    imu_codec_finalizar(&c);
+}
+
+bool imu_codec_valido(const uint8_t *bloco, imu_bloco_cab_t *cab){
+    memcpy(cab, bloco, sizeof(*cab));
+    if (cab->magic != IMU_BLOCO_MAGIC || cab->versao != IMU_BLOCO_VERSAO) return false;
+    unsigned short crc = 0;
+    update_crc16(&crc, (const char *)bloco, offsetof(imu_bloco_cab_t, crc));
+    const char zero[2] = {0, 0};
+    update_crc16(&crc, zero, sizeof(zero));
+    update_crc16(&crc, (const char *)bloco + offsetof(imu_bloco_cab_t, reservado),
+                 IMU_BLOCO_TAM - offsetof(imu_bloco_cab_t, reservado));
+    return crc == cab->crc;
+}
+
+int imu_codec_decodificar(const uint8_t *bloco, int16_t *saida, size_t max_amostras){
+    imu_bloco_cab_t cab;
+    memcpy(&cab, bloco, sizeof(cab));
+    if (cab.magic != IMU_BLOCO_MAGIC || (cab.versao != 1 && cab.versao != IMU_BLOCO_VERSAO)) return -1;
+    size_t tam_cab = cab.versao == 1 ? IMU_CAB_V1_TAM : sizeof(cab);
+    if (cab.canais == 0) return cab.amostras ? -1 : 0; // Bloco de anotação: só texto
+    if (cab.canais > IMU_CANAIS_MAX || cab.amostras > max_amostras) return -1;
+    if (tam_cab + cab.bytes > IMU_BLOCO_TAM) return -1;
+
+    const uint8_t *p = bloco + tam_cab;
+    const uint8_t *fim = p + cab.bytes;
+    for (uint16_t a = 0; a < cab.amostras; a++){
+        int16_t *s = saida + (size_t)a * cab.canais;
+        for (uint8_t i = 0; i < cab.canais; i++){
+            if (a == 0){
+                if (p + 2 > fim) return -1;
+                s[i] = (int16_t)(p[0] | (p[1] << 8));
+                p += 2;
+            } else {
+                uint32_t u = 0;
+                for (int desloc = 0;; desloc += 7){
+                    if (p >= fim || desloc > 14) return -1;
+                    uint8_t b = *p++;
+                    u |= (uint32_t)(b & 0x7F) << desloc;
+                    if (!(b & 0x80)) break;
+                }
+                s[i] = (int16_t)(s[i - (int)cab.canais] + unzigzag(u));
+            }
+        }
+    }
+    return cab.amostras;
+}
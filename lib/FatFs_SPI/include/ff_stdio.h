@@ -13,6 +13,7 @@ specific language governing permissions and limitations under the License.
 */
 // For compatibility with FreeRTOS+FAT API
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,9 +23,7 @@ specific language governing permissions and limitations under the License.
 #include "my_debug.h"
 
 #define BaseType_t int
-#define FF_FILE FIL
 
-#define ff_rewind f_rewind
 #define pvPortMalloc malloc
 #define vPortFree free
 #define ffconfigMAX_FILENAME 250
@@ -37,8 +36,28 @@ specific language governing permissions and limitations under the License.
 #define FF_SEEK_END 2
 #define pdFALSE 0
 #define pdTRUE 1
-#define ff_filelength f_size
-#define ff_feof f_eof
+#define ffconfigFPRINTF_BUFFER_LENGTH 128
+
+// Stream buffering, as in setvbuf(3)
+#define FF_IOFBF 0 /* Full buffering */
+#define FF_IOLBF 1 /* Line buffering: writes are flushed at each '\n' */
+#define FF_IONBF 2 /* No buffering: every call goes straight to FatFs */
+// Default buffer, allocated on first I/O. A multiple of the sector size keeps
+// flushes sector aligned, so FatFs writes them without its own window copy.
+#define FF_STDIO_BUFSIZE FF_MIN_SS
+
+// A FatFs file with a stdio-style buffer in front of it. The buffer holds
+// either pending writes or read-ahead, never both.
+typedef struct {
+    FIL fil;
+    uint8_t *buf;
+    size_t size;     // Buffer capacity; 0 until the first I/O
+    size_t pos;      // Next byte to read or write in buf
+    size_t len;      // Valid read-ahead bytes in buf
+    uint8_t vbuf;    // FF_IOFBF, FF_IOLBF or FF_IONBF
+    uint8_t state;   // Idle, writing or reading (see ff_stdio.c)
+    bool own_buf;    // buf was malloc'ed here
+} FF_FILE;
 
 typedef struct FF_STAT {
     uint32_t st_size; /* Size of the object in number of bytes. */
@@ -75,3 +94,11 @@ FF_FILE *ff_truncate( const char * pcFileName, long lTruncateSize );
 int ff_seteof( FF_FILE *pxStream );
 int ff_rename( const char *pcOldName, const char *pcNewName, int bDeleteIfExists );
 char *ff_fgets(char *pcBuffer, size_t xCount, FF_FILE *pxStream);
+int ff_fprintf(FF_FILE *pxStream, const char *pcFormat, ...);
+int ff_fflush(FF_FILE *pxStream);
+// Must be called before the buffer holds data (right after ff_fopen, or after
+// ff_fflush/ff_fseek). pcBuffer NULL allocates xSize bytes on first use.
+int ff_setvbuf(FF_FILE *pxStream, char *pcBuffer, int iMode, size_t xSize);
+int ff_rewind(FF_FILE *pxStream);
+long ff_filelength(FF_FILE *pxStream);
+int ff_feof(FF_FILE *pxStream);
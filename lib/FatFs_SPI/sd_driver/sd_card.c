@@ -346,21 +346,49 @@ static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
     return response;
 }
 
-static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
-    char resp;
+// Card-busy waits are polled flat out for the first SD_BUSY_SPIN bytes, which
+// covers command turnaround and most read latencies. Past that the card is
+// programming flash (hundreds of us up to hundreds of ms), so the core sleeps
+// on a timer alarm between polls, doubling the interval up to
+// SD_BUSY_BACKOFF_MAX_US. Interrupts keep running and the registered busy hook
+// gets the idle time instead of the SPI bus. The cap bounds how late a finished
+// write is noticed: a typical 0.3-1 ms page program ends at most 256 us late.
+#define SD_BUSY_SPIN 32
+#define SD_BUSY_BACKOFF_MIN_US 16
+#define SD_BUSY_BACKOFF_MAX_US 256
+
+static sd_busy_hook_t busy_hook;
+
+void sd_set_busy_hook(sd_busy_hook_t hook) { busy_hook = hook; }
+
+// Polls until the card releases DO (token < 0: any byte but 0x00) or sends
+// 'token'. A zero timeout polls exactly once.
+static bool sd_poll(sd_card_t *pSD, uint32_t timeout_ms, int token) {
+    absolute_time_t timeout_time = make_timeout_time_ms(timeout_ms);
+    uint32_t backoff_us = SD_BUSY_BACKOFF_MIN_US;
+    for (uint32_t polls = 1;; polls++) {
+        uint8_t resp = sd_spi_write(pSD, SPI_FILL_CHAR);
+        if (token < 0 ? resp != 0x00 : resp == token) return true;
+        if (0 >= absolute_time_diff_us(get_absolute_time(), timeout_time))
+            return false;
+        if (polls < SD_BUSY_SPIN) continue;
+        absolute_time_t next = make_timeout_time_us(backoff_us);
+        if (absolute_time_diff_us(next, timeout_time) < 0) next = timeout_time;
+        // Any event (another core's SEV, an IRQ) wakes the core early; run the
+        // hook each time and go back to sleep until the alarm is due
+        do {
+            if (busy_hook) busy_hook();
+        } while (!best_effort_wfe_or_timeout(next));
+        if (backoff_us < SD_BUSY_BACKOFF_MAX_US) backoff_us <<= 1;
+    }
+}
 
+static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
     // Keep sending dummy clocks with DI held high until the card releases the
     // DO line
-    absolute_time_t timeout_time = make_timeout_time_ms(timeout);
-    do {
-        resp = sd_spi_write(pSD, 0xFF);
-    } while (resp == 0x00 &&
-             0 < absolute_time_diff_us(get_absolute_time(), timeout_time));
-
-    if (resp == 0x00) DBG_PRINTF("%s failed\r\n", __FUNCTION__);
-
-    // Return success/failure
-    return (resp > 0x00);
+    bool ready = sd_poll(pSD, timeout, -1);
+    if (!ready) DBG_PRINTF("%s failed\r\n", __FUNCTION__);
+    return ready;
 }
 
 // An SD card can only do one thing at a time.
@@ -477,6 +505,7 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
         response = sd_cmd_spi(pSD, cmd, arg);
         if (R1_NO_RESPONSE == response) {
             DBG_PRINTF("No response CMD:%d\r\n", cmd);
+            pSD->cmd_retries++;
             continue;
         }
         break;
@@ -763,13 +792,8 @@ uint64_t sd_sectors(sd_card_t *pSD) {
 static bool sd_wait_token(sd_card_t *pSD, uint8_t token) {
     TRACE_PRINTF("%s(0x%02hhx)\r\n", __FUNCTION__, token);
 
-    const uint32_t timeout = SD_COMMAND_TIMEOUT;  // Wait for start token
-    absolute_time_t timeout_time = make_timeout_time_ms(timeout);
-    do {
-        if (token == sd_spi_write(pSD, SPI_FILL_CHAR)) {
-            return true;
-        }
-    } while (0 < absolute_time_diff_us(get_absolute_time(), timeout_time));
+    // The card sends 0xFF until the data is ready, then the start token
+    if (sd_poll(pSD, SD_COMMAND_TIMEOUT, token)) return true;
     DBG_PRINTF("sd_wait_token: timeout\r\n");
     return false;
 }
@@ -1024,6 +1048,32 @@ int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
     return status;
 }
 
+// Erases the inclusive sector range [ulStartSector, ulEndSector] (TRIM).
+// Cards that do not support erase simply report an error, which callers may ignore.
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulStartSector,
+                    uint64_t ulEndSector) {
+    if (ulEndSector < ulStartSector || ulEndSector >= pSD->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (pSD->m_Status & (STA_NOINIT | STA_NODISK))
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    sd_acquire(pSD);
+    TRACE_PRINTF("sd_erase_blocks(0x%llx, 0x%llx)\r\n", ulStartSector,
+                 ulEndSector);
+    // SDSC Card (CCS=0) uses byte unit address
+    uint64_t start = ulStartSector, end = ulEndSector;
+    if (SDCARD_V2HC != pSD->card_type) {
+        start *= _block_size;
+        end *= _block_size;
+    }
+    int status = sd_cmd(pSD, CMD32_ERASE_WR_BLK_START_ADDR, start, false, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == status)
+        status = sd_cmd(pSD, CMD33_ERASE_WR_BLK_END_ADDR, end, false, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == status)
+        status = sd_cmd(pSD, CMD38_ERASE, 0, false, 0);  // R1b: waits while busy
+    sd_release(pSD);
+    return status;
+}
+
 static int sd_init_medium(sd_card_t *pSD) {
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
     uint32_t response, arg;
@@ -54,6 +54,7 @@ struct sd_card_t {
     mutex_t mutex;
     FATFS fatfs;
     bool mounted;
+    uint32_t cmd_retries;                            // Commands re-sent for lack of response
 
     int (*init)(sd_card_t *sd_card_p);
     int (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
@@ -89,6 +90,16 @@ struct sd_card_t {
 
 bool sd_card_detect(sd_card_t *pSD);
 uint64_t sd_sectors(sd_card_t *pSD);
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulStartSector, uint64_t ulEndSector);
+
+// Called while a card-busy wait sleeps between polls. The card and its SPI bus
+// stay locked meanwhile, so the hook must not touch the SD card.
+typedef void (*sd_busy_hook_t)(void);
+void sd_set_busy_hook(sd_busy_hook_t hook);
+
+// TRIM (CMD38) can hold the card, and the FatFs volume, for seconds. While
+// disabled, CTRL_TRIM succeeds without erasing: freed clusters just go unhinted.
+void sd_set_trim_enabled(bool enabled);
 
 bool sd_init_driver();
 bool sd_card_detect(sd_card_t *sd_card_p);
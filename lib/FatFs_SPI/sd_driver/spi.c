@@ -59,7 +59,39 @@ void set_spi_dma_irq_channel(bool useChannel1, bool shared) {
 //   If the data that will be transmitted is not important,
 //     pass NULL as tx and then the SPI_FILL_CHAR is sent out as each data
 //     element.
+// Command bytes, R1 and token polls and CRCs are one or a few bytes each;
+// for those, setting up two DMA channels and waiting for the IRQ costs far
+// more than the transfer itself, so they go through the FIFOs directly.
+// Data blocks still use DMA.
 bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+    if (length <= spi_p->polled_max)
+        return spi_transfer_polled(spi_p, tx, rx, length);
+    return spi_transfer_dma(spi_p, tx, rx, length);
+}
+
+// Register-level transfer: keeps at most a FIFO's worth (8 frames) in flight
+// so the RX FIFO can never overflow.
+bool spi_transfer_polled(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+    assert(tx || rx);
+    spi_hw_t *hw = spi_get_hw(spi_p->hw_inst);
+    const size_t fifo_depth = 8;
+    size_t tx_remaining = length, rx_remaining = length;
+    while (tx_remaining || rx_remaining) {
+        if (tx_remaining && rx_remaining < tx_remaining + fifo_depth &&
+            (hw->sr & SPI_SSPSR_TNF_BITS)) {
+            hw->dr = tx ? *tx++ : SPI_FILL_CHAR;
+            --tx_remaining;
+        }
+        if (rx_remaining && (hw->sr & SPI_SSPSR_RNE_BITS)) {
+            uint8_t received = (uint8_t)hw->dr;
+            if (rx) *rx++ = received;
+            --rx_remaining;
+        }
+    }
+    return true;
+}
+
+bool spi_transfer_dma(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     // assert(512 == length || 1 == length);
     assert(tx || rx);
     // assert(!(tx && rx));
@@ -153,6 +185,8 @@ bool my_spi_init(spi_t *spi_p) {
         // Default:
         if (!spi_p->baud_rate)
             spi_p->baud_rate = 10 * 1000 * 1000;
+        if (!spi_p->polled_max)
+            spi_p->polled_max = SPI_POLLED_MAX;
         // For the IRQ notification:
         sem_init(&spi_p->sem, 0, 1);
 
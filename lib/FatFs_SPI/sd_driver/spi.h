@@ -26,6 +26,8 @@ specific language governing permissions and limitations under the License.
 #include "pico/types.h"
 
 #define SPI_FILL_CHAR (0xFF)
+// Transfers up to this length are done by polling the FIFOs instead of by DMA
+#define SPI_POLLED_MAX 16
 
 // "Class" representing SPIs
 typedef struct {
@@ -36,6 +38,7 @@ typedef struct {
     uint sck_gpio;
     uint baud_rate;
     uint DMA_IRQ_num; // DMA_IRQ_0 or DMA_IRQ_1
+    uint polled_max;  // Longest polled transfer; my_spi_init() sets SPI_POLLED_MAX if 0. 0 afterwards = always DMA
 
     // Drive strength levels for GPIO outputs.
     // enum gpio_drive_strength { GPIO_DRIVE_STRENGTH_2MA = 0, GPIO_DRIVE_STRENGTH_4MA = 1, GPIO_DRIVE_STRENGTH_8MA = 2,
@@ -60,6 +63,8 @@ extern "C" {
 #endif
   
 bool __not_in_flash_func(spi_transfer)(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);  
+bool __not_in_flash_func(spi_transfer_dma)(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);
+bool __not_in_flash_func(spi_transfer_polled)(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);
 void spi_lock(spi_t *pSPI);
 void spi_unlock(spi_t *pSPI);
 bool my_spi_init(spi_t *pSPI);
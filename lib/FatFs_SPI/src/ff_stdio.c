@@ -15,7 +15,9 @@ specific language governing permissions and limitations under the License.
 
 #include <errno.h>
 #include <limits.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -27,6 +29,9 @@ specific language governing permissions and limitations under the License.
 #define TRACE_PRINTF(fmt, args...) {}
 //#define TRACE_PRINTF printf
 
+// FF_FILE.state
+enum { ST_IDLE, ST_WRITE, ST_READ };
+
 static BYTE posix2mode(const char *pcMode) {
     if (0 == strcmp("r", pcMode)) return FA_READ;
     if (0 == strcmp("r+", pcMode)) return FA_READ | FA_WRITE;
@@ -86,6 +91,124 @@ int fresult2errno(FRESULT fr) {
     }
 }
 
+static FF_FILE *stream_new(void) {
+    FF_FILE *fp = malloc(sizeof(FF_FILE));
+    if (!fp) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(fp, 0, sizeof *fp);
+    fp->vbuf = FF_IOFBF;
+    return fp;
+}
+
+// Writes out pending bytes, or drops read-ahead and moves the FatFs position
+// back to the logical one. Leaves the stream idle.
+static FRESULT stream_sync(FF_FILE *fp) {
+    FRESULT fr = FR_OK;
+    if (ST_WRITE == fp->state && fp->pos) {
+        UINT bw = 0;
+        fr = f_write(&fp->fil, fp->buf, fp->pos, &bw);
+        if (FR_OK == fr && bw != fp->pos) fr = FR_DENIED;  // Volume full
+    } else if (ST_READ == fp->state && fp->pos < fp->len) {
+        fr = f_lseek(&fp->fil, f_tell(&fp->fil) - (fp->len - fp->pos));
+    }
+    fp->pos = fp->len = 0;
+    fp->state = ST_IDLE;
+    return fr;
+}
+
+// Allocates the default buffer on first I/O. False means unbuffered.
+static bool stream_buffered(FF_FILE *fp) {
+    if (FF_IONBF == fp->vbuf) return false;
+    if (!fp->buf) {
+        if (!fp->size) fp->size = FF_STDIO_BUFSIZE;
+        fp->buf = malloc(fp->size);
+        if (!fp->buf) {
+            fp->vbuf = FF_IONBF;
+            return false;
+        }
+        fp->own_buf = true;
+    }
+    return true;
+}
+
+static bool sector_aligned(FF_FILE *fp) {
+    return 0 == f_tell(&fp->fil) % FF_MIN_SS;
+}
+
+static size_t stream_write(FF_FILE *fp, const uint8_t *src, size_t n) {
+    UINT bw = 0;
+    FRESULT fr = FR_OK;
+    if (ST_READ == fp->state) fr = stream_sync(fp);
+    if (FR_OK == fr && !stream_buffered(fp)) {
+        fr = f_write(&fp->fil, src, n, &bw);
+        errno = fresult2errno(fr);
+        return bw;
+    }
+    size_t done = 0;
+    while (FR_OK == fr && done < n) {
+        size_t left = n - done;
+        if (!fp->pos && left >= FF_MIN_SS && left >= fp->size && sector_aligned(fp)) {
+            // Whole sectors from an empty buffer: hand them to FatFs as they are
+            size_t chunk = left - left % FF_MIN_SS;
+            fr = f_write(&fp->fil, src + done, chunk, &bw);
+            done += bw;
+            if (FR_OK == fr && bw != chunk) fr = FR_DENIED;
+            continue;
+        }
+        size_t chunk = fp->size - fp->pos;
+        if (chunk > left) chunk = left;
+        memcpy(fp->buf + fp->pos, src + done, chunk);
+        fp->pos += chunk;
+        fp->state = ST_WRITE;
+        done += chunk;
+        if (fp->pos == fp->size ||
+            (FF_IOLBF == fp->vbuf && memchr(src + done - chunk, '\n', chunk)))
+            fr = stream_sync(fp);
+    }
+    errno = fresult2errno(fr);
+    return FR_OK == fr ? done : 0;  // A failed flush loses buffered bytes too
+}
+
+static size_t stream_read(FF_FILE *fp, uint8_t *dst, size_t n) {
+    UINT br = 0;
+    FRESULT fr = FR_OK;
+    if (ST_WRITE == fp->state) fr = stream_sync(fp);
+    if (FR_OK == fr && !stream_buffered(fp)) {
+        fr = f_read(&fp->fil, dst, n, &br);
+        errno = fresult2errno(fr);
+        return br;
+    }
+    size_t done = 0;
+    while (FR_OK == fr && done < n) {
+        if (fp->pos < fp->len) {
+            size_t chunk = fp->len - fp->pos;
+            if (chunk > n - done) chunk = n - done;
+            memcpy(dst + done, fp->buf + fp->pos, chunk);
+            fp->pos += chunk;
+            done += chunk;
+            continue;
+        }
+        size_t left = n - done;
+        fp->pos = fp->len = 0;
+        fp->state = ST_IDLE;
+        if (left >= FF_MIN_SS && left >= fp->size && sector_aligned(fp)) {
+            size_t chunk = left - left % FF_MIN_SS;
+            fr = f_read(&fp->fil, dst + done, chunk, &br);
+            done += br;
+            if (br != chunk) break;  // End of file
+            continue;
+        }
+        fr = f_read(&fp->fil, fp->buf, fp->size, &br);
+        if (!br) break;
+        fp->len = br;
+        fp->state = ST_READ;
+    }
+    errno = fresult2errno(fr);
+    return done;
+}
+
 FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     TRACE_PRINTF("%s\n", __func__);
     // FRESULT f_open (FIL* fp, const TCHAR* path, BYTE mode);
@@ -94,12 +217,9 @@ FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     //  const TCHAR* path, /* [IN] File name */
     //  BYTE mode          /* [IN] Mode flags */
     //);
-    FIL *fp = malloc(sizeof(FIL));
-    if (!fp) {
-        errno = ENOMEM;
-        return NULL;
-    }
-    FRESULT fr = f_open(fp, pcFile, posix2mode(pcMode));
+    FF_FILE *fp = stream_new();
+    if (!fp) return NULL;
+    FRESULT fr = f_open(&fp->fil, pcFile, posix2mode(pcMode));
     errno = fresult2errno(fr);
     if (FR_OK != fr) {
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
@@ -113,16 +233,37 @@ int ff_fclose(FF_FILE *pxStream) {
     // FRESULT f_close (
     //  FIL* fp     /* [IN] Pointer to the file object */
     //);
-    FRESULT fr = f_close(pxStream);
+    FRESULT fr = stream_sync(pxStream);
+    FRESULT fr2 = f_close(&pxStream->fil);
+    if (FR_OK == fr) fr = fr2;
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
+    if (pxStream->own_buf) free(pxStream->buf);
     free(pxStream);
     if (FR_OK == fr)
         return 0;
     else
         return -1;
 }
+int ff_fflush(FF_FILE *pxStream) {
+    FRESULT fr = stream_sync(pxStream);
+    errno = fresult2errno(fr);
+    return FR_OK == fr ? 0 : FF_EOF;
+}
+int ff_setvbuf(FF_FILE *pxStream, char *pcBuffer, int iMode, size_t xSize) {
+    if (iMode < FF_IOFBF || iMode > FF_IONBF || pxStream->state != ST_IDLE ||
+        (FF_IONBF != iMode && !xSize)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (pxStream->own_buf) free(pxStream->buf);
+    pxStream->buf = (uint8_t *)pcBuffer;
+    pxStream->own_buf = false;
+    pxStream->size = FF_IONBF == iMode ? 0 : xSize;
+    pxStream->vbuf = iMode;
+    return 0;
+}
 // Populates an ff_stat_struct with information about a file.
 int ff_stat(const char *pcFileName, FF_Stat_t *pxStatBuffer) {
     TRACE_PRINTF("%s\n", __func__);
@@ -145,35 +286,14 @@ int ff_stat(const char *pcFileName, FF_Stat_t *pxStatBuffer) {
 size_t ff_fwrite(const void *pvBuffer, size_t xSize, size_t xItems,
                  FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    // FRESULT f_write (
-    //  FIL* fp,          /* [IN] Pointer to the file object structure */
-    //  const void* buff, /* [IN] Pointer to the data to be written */
-    //  UINT btw,         /* [IN] Number of bytes to write */
-    //  UINT* bw          /* [OUT] Pointer to the variable to return number of
-    //  bytes written */
-    //);
-    UINT bw = 0;
-    FRESULT fr = f_write(pxStream, pvBuffer, xSize * xItems, &bw);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
-    return bw / xSize;
+    if (!xSize) return 0;
+    return stream_write(pxStream, pvBuffer, xSize * xItems) / xSize;
 }
 size_t ff_fread(void *pvBuffer, size_t xSize, size_t xItems,
                 FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    // FRESULT f_read (
-    //  FIL* fp,     /* [IN] File object */
-    //  void* buff,  /* [OUT] Buffer to store read data */
-    //  UINT btr,    /* [IN] Number of bytes to read */
-    //  UINT* br     /* [OUT] Number of bytes read */
-    //);
-    UINT br = 0;
-    FRESULT fr = f_read(pxStream, pvBuffer, xSize * xItems, &br);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
-    return br / xSize;
+    if (!xSize) return 0;
+    return stream_read(pxStream, pvBuffer, xSize * xItems) / xSize;
 }
 int ff_chdir(const char *pcDirectoryName) {
     TRACE_PRINTF("%s\n", __func__);
@@ -230,48 +350,32 @@ int ff_mkdir(const char *pcDirectoryName) {
 }
 int ff_fputc(int iChar, FF_FILE *pxStream) {
     // TRACE_PRINTF("%s(iChar=%c,pxStream=%p)\n", __func__, iChar, pxStream);
-    // FRESULT f_write (
-    //  FIL* fp,          /* [IN] Pointer to the file object structure */
-    //  const void* buff, /* [IN] Pointer to the data to be written */
-    //  UINT btw,         /* [IN] Number of bytes to write */
-    //  UINT* bw          /* [OUT] Pointer to the variable to return number of
-    //  bytes written */
-    //);
-    UINT bw = 0;
-    uint8_t buff[1];
-    buff[0] = iChar;
-    FRESULT fr = f_write(pxStream, buff, 1, &bw);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
+    // Common case: room in a write buffer, no line flush due
+    if (ST_WRITE == pxStream->state && pxStream->pos + 1 < pxStream->size &&
+        !(FF_IOLBF == pxStream->vbuf && '\n' == iChar)) {
+        pxStream->buf[pxStream->pos++] = iChar;
+        return (uint8_t)iChar;
+    }
+    uint8_t c = iChar;
     // On success the byte written to the file is returned. If any other value
     // is returned then the byte was not written to the file and the task's
     // errno will be set to indicate the reason.
-    if (1 == bw)
-        return iChar;
+    if (1 == stream_write(pxStream, &c, 1))
+        return c;
     else {
         return -1;
     }
 }
 int ff_fgetc(FF_FILE *pxStream) {
     // TRACE_PRINTF("%s(pxStream=%p)\n", __func__, pxStream);
-    // FRESULT f_read (
-    //  FIL* fp,     /* [IN] File object */
-    //  void* buff,  /* [OUT] Buffer to store read data */
-    //  UINT btr,    /* [IN] Number of bytes to read */
-    //  UINT* br     /* [OUT] Number of bytes read */
-    //);
-    uint8_t buff[1] = {0};
-    UINT br;
-    FRESULT fr = f_read(pxStream, buff, 1, &br);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
+    if (ST_READ == pxStream->state && pxStream->pos < pxStream->len)
+        return pxStream->buf[pxStream->pos++];
+    uint8_t c;
     // On success the byte read from the file system is returned. If a byte
     // could not be read from the file because the read position is already at
     // the end of the file then FF_EOF is returned.
-    if (1 == br)
-        return buff[0];
+    if (1 == stream_read(pxStream, &c, 1))
+        return c;
     else
         return FF_EOF;
 }
@@ -299,30 +403,43 @@ int ff_remove(const char *pcPath) {
     else
         return -1;
 }
+// Logical position: FatFs position plus pending writes, minus unread read-ahead
+static FSIZE_t stream_tell(FF_FILE *fp) {
+    FSIZE_t pos = f_tell(&fp->fil);
+    if (ST_WRITE == fp->state) return pos + fp->pos;
+    if (ST_READ == fp->state) return pos - (fp->len - fp->pos);
+    return pos;
+}
 long ff_ftell(FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
     // FSIZE_t f_tell (
     //  FIL* fp   /* [IN] File object */
     //);
-    FSIZE_t pos = f_tell(pxStream);
+    FSIZE_t pos = stream_tell(pxStream);
     myASSERT(pos < LONG_MAX);
     return pos;
 }
 int ff_fseek(FF_FILE *pxStream, int iOffset, int iWhence) {
     TRACE_PRINTF("%s\n", __func__);
-    FRESULT fr = -1;
+    FRESULT fr = stream_sync(pxStream);
+    if (FR_OK != fr) {
+        errno = fresult2errno(fr);
+        return -1;
+    }
+    FIL *fil = &pxStream->fil;
+    fr = -1;
     switch (iWhence) {
         case FF_SEEK_CUR:  // The current file position.
-            if ((int)f_tell(pxStream) + iOffset < 0) return -1;
-            fr = f_lseek(pxStream, f_tell(pxStream) + iOffset);
+            if ((int)f_tell(fil) + iOffset < 0) return -1;
+            fr = f_lseek(fil, f_tell(fil) + iOffset);
             break;
         case FF_SEEK_END:  // The end of the file.
-            if ((int)f_size(pxStream) + iOffset < 0) return -1;
-            fr = f_lseek(pxStream, f_size(pxStream) + iOffset);
+            if ((int)f_size(fil) + iOffset < 0) return -1;
+            fr = f_lseek(fil, f_size(fil) + iOffset);
             break;
         case FF_SEEK_SET:  // The beginning of the file.
             if (iOffset < 0) return -1;
-            fr = f_lseek(pxStream, iOffset);
+            fr = f_lseek(fil, iOffset);
             break;
         default:
             myASSERT(!"Bad iWhence");
@@ -333,6 +450,18 @@ int ff_fseek(FF_FILE *pxStream, int iOffset, int iWhence) {
     else
         return -1;
 }
+int ff_rewind(FF_FILE *pxStream) {
+    return ff_fseek(pxStream, 0, FF_SEEK_SET);
+}
+long ff_filelength(FF_FILE *pxStream) {
+    FSIZE_t size = f_size(&pxStream->fil);
+    FSIZE_t pos = stream_tell(pxStream);
+    return pos > size ? pos : size;  // Pending writes may extend the file
+}
+int ff_feof(FF_FILE *pxStream) {
+    if (ST_READ == pxStream->state && pxStream->pos < pxStream->len) return 0;
+    return stream_tell(pxStream) >= (FSIZE_t)ff_filelength(pxStream);
+}
 int ff_findfirst(const char *pcDirectory, FF_FindData_t *pxFindData) {
     TRACE_PRINTF("%s(%s)\n", __func__, pcDirectory);
     // FRESULT f_findfirst (
@@ -389,16 +518,17 @@ int ff_findnext(FF_FindData_t *pxFindData) {
 }
 FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
     TRACE_PRINTF("%s\n", __func__);
-    FIL *fp = malloc(sizeof(FIL));
-    if (!fp) {
-        errno = ENOMEM;
-        return NULL;
-    }
+    FF_FILE *stream = stream_new();
+    if (!stream) return NULL;
+    FIL *fp = &stream->fil;
     FRESULT fr = f_open(fp, pcFileName, FA_OPEN_APPEND | FA_WRITE);
     if (FR_OK != fr)
         printf("%s: f_open error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    if (FR_OK != fr) return NULL;
+    if (FR_OK != fr) {
+        free(stream);
+        return NULL;
+    }
     while (f_tell(fp) < (FSIZE_t)lTruncateSize) {
         UINT bw = 0;
         char c = 0;
@@ -406,26 +536,36 @@ FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
         if (FR_OK != fr)
             TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
         errno = fresult2errno(fr);
-        if (1 != bw) return NULL;
+        if (1 != bw) {
+            f_close(fp);
+            free(stream);
+            return NULL;
+        }
     }
     fr = f_lseek(fp, lTruncateSize);
     errno = fresult2errno(fr);
     if (FR_OK != fr)
         printf("%s: f_lseek error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    if (FR_OK != fr) return NULL;
+    if (FR_OK != fr) {
+        f_close(fp);
+        free(stream);
+        return NULL;
+    }
     fr = f_truncate(fp);
     if (FR_OK != fr)
         printf("%s: f_truncate error: %s (%d)\n", __func__, FRESULT_str(fr),
                fr);
     errno = fresult2errno(fr);
     if (FR_OK == fr)
-        return fp;
-    else
-        return NULL;
+        return stream;
+    f_close(fp);
+    free(stream);
+    return NULL;
 }
 int ff_seteof(FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    FRESULT fr = f_truncate(pxStream);
+    FRESULT fr = stream_sync(pxStream);
+    if (FR_OK == fr) fr = f_truncate(&pxStream->fil);
     errno = fresult2errno(fr);
     if (FR_OK == fr)
         return 0;
@@ -451,13 +591,32 @@ int ff_rename(const char *pcOldName, const char *pcNewName,
 }
 char *ff_fgets(char *pcBuffer, size_t xCount, FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    TCHAR *p = f_gets(pcBuffer, xCount, pxStream);
+    // f_gets would read one byte per f_read; scan the buffer instead
+    size_t n = 0;
+    while (n + 1 < xCount) {
+        int c = ff_fgetc(pxStream);
+        if (FF_EOF == c) break;
+        pcBuffer[n++] = c;
+        if ('\n' == c) break;
+    }
+    if (xCount) pcBuffer[n] = 0;
     // On success a pointer to pcBuffer is returned. If there is a read error
     // then NULL is returned and the task's errno is set to indicate the reason.
-    if (p == pcBuffer)
+    if (n)
         return pcBuffer;
     else {
         errno = EIO;
         return NULL;
     }
 }
+int ff_fprintf(FF_FILE *pxStream, const char *pcFormat, ...) {
+    // As in FreeRTOS+FAT, output longer than the buffer is truncated
+    char buf[ffconfigFPRINTF_BUFFER_LENGTH];
+    va_list args;
+    va_start(args, pcFormat);
+    int n = vsnprintf(buf, sizeof buf, pcFormat, args);
+    va_end(args);
+    if (n < 0) return -1;
+    if ((size_t)n >= sizeof buf) n = sizeof buf - 1;
+    return stream_write(pxStream, (const uint8_t *)buf, n) == (size_t)n ? n : -1;
+}
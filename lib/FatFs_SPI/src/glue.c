@@ -32,6 +32,10 @@ specific language governing permissions and limitations under the License.
 #define TRACE_PRINTF(fmt, args...)
 //#define TRACE_PRINTF printf  // task_printf
 
+static volatile bool trim_enabled = true;
+
+void sd_set_trim_enabled(bool enabled) { trim_enabled = enabled; }
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -162,6 +166,15 @@ DRESULT disk_ioctl(BYTE pdrv, /* Physical drive nmuber (0..) */
         }
         case CTRL_SYNC:
             return RES_OK;
+#if FF_USE_TRIM
+        case CTRL_TRIM: {  // Informs the device that the data on the block of
+                           // sectors is no longer used. buff points to an LBA_t
+                           // array {start sector, end sector}, inclusive.
+            LBA_t *range = (LBA_t *)buff;
+            if (!trim_enabled) return RES_OK;
+            return sdrc2dresult(sd_erase_blocks(p_sd, range[0], range[1]));
+        }
+#endif
         default:
             return RES_PARERR;
     }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+#include "lib/ssd1306.h"
+
+// Orientação por filtro de Mahony em ponto fixo: o giroscópio integra o
+// quaternion e o erro entre a gravidade medida e a estimada corrige a deriva
+// (proporcional + integral). Quaternion em Q30, só multiplicações de 32x32 bits,
+// uma raiz inteira e três divisões de hardware por amostra. Roda no core1.
+#define AHRS_CANAIS AMOSTRA_EXTRAS     // qw, qx, qy, qz gravados em Q14
+#define AHRS_Q 30
+#define AHRS_RAD_LSB_Q40 146489298u    // rad/s por LSB do giroscópio (±250 °/s, 131 LSB/(°/s)) em Q40
+#define AHRS_PARTIDA_GANHO 10          // Kp multiplicado no primeiro segundo: converge rápido e depois filtra
+
+typedef struct {
+    bool ligado;
+    uint32_t kp_x10;   // Ganho proporcional x10
+    uint32_t ki_x1000; // Ganho integral x1000
+} ahrs_cfg_t;
+
+extern ahrs_cfg_t ahrs_cfg;         // Alterado só com a captura parada
+extern const char ahrs_cabecalho[]; // ",qw,qx,qy,qz" acrescentado às colunas do CSV
+
+void ahrs_imprimir(void);
+void ahrs_reiniciar(uint32_t periodo_us);          // Antes da captura: quaternion identidade e ganhos por amostra
+void ahrs_amostra(int16_t canais[]);               // core1: atualiza com ax..gz e escreve o quaternion Q14 em canais[MPU6050_CANAIS..]
+void ahrs_euler(int16_t graus[3]);                 // Roll, pitch e yaw do último quaternion
+void ahrs_desenhar(ssd1306_t *ssd, uint8_t y);     // Uma linha com roll, pitch e yaw
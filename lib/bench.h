@@ -0,0 +1,4 @@
+#pragma once
+
+// Handler do comando "bench <teste>": benchmarks e testes de equivalência executados no próprio RP2040
+void run_bench(void);
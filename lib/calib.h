@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+
+// Calibração aplicada na aquisição: o giroscópio perde o bias e o acelerômetro
+// passa por offset e ganho Q14, só com multiplicação e deslocamento. Os
+// coeficientes ficam no último setor da flash e sobrevivem ao desligamento.
+#define CALIB_1G 16384           // LSB por g na escala de ±2 g
+#define CALIB_Q 14               // Bits fracionários do ganho
+#define CALIB_UM (1 << CALIB_Q)  // Ganho 1,0
+#define CALIB_ESCALA_MIN 12288   // Ganhos fora de [0,75; 1,25] indicam medição errada
+#define CALIB_ESCALA_MAX 20480
+#define CALIB_AMOSTRAS 512       // Leituras médias por posição (~0,5 s)
+#define CALIB_TXT_MAX 128        // Maior linha "# calib ...\n"
+
+typedef struct {
+    int16_t gyro_bias[3];     // LSB subtraídos do giroscópio
+    int16_t accel_offset[3];  // LSB subtraídos do acelerômetro antes do ganho
+    uint16_t accel_escala[3]; // Ganho Q14 do acelerômetro
+} calib_t;
+
+void calib_carregar(void);                    // Lê a calibração gravada na flash (boot)
+bool calib_repouso(void);                     // Placa parada com Z para cima: bias e offsets, ganho mantido
+bool calib_seis_posicoes(void);               // Uma medição com cada face para cima: offsets e ganhos
+bool calib_salvar(void);                      // Grava a calibração atual na flash
+void calib_apagar(void);                      // Volta aos dados crus e apaga a flash
+bool calib_ativa(void);
+void calib_aplicar(int16_t canais[MPU6050_CANAIS]); // Caminho quente: corrige uma amostra no lugar
+size_t calib_registro(char *dst, size_t tam); // Linha "# calib ...\n" para o cabeçalho do log; 0 se inativa
+void calib_imprimir(void);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CSV_REG_MAX 64 // Maior linha possível: id de 10 dígitos, 6 canais de 6 caracteres, temperatura e '\n'
+
+// Formata uma linha "id,ax,ay,az,gx,gy,gz,temp\n" diretamente em dst, sem printf nem float.
+// Produz exatamente os mesmos bytes que "%d,%ld,...,%.1f\n" com temp / 340.0f + 36.53f.
+// dst precisa de pelo menos CSV_REG_MAX bytes livres; retorna o número de bytes escritos (sem '\0').
+size_t csv_fmt_registro(char *dst, uint32_t id, const int16_t accel[3], const int16_t gyro[3], int16_t temp);
+
+char *csv_fmt_u32(char *p, uint32_t v);  // Escreve v em decimal e retorna o fim
+char *csv_fmt_i32(char *p, int32_t v);   // Idem, com sinal
+char *csv_fmt_temp(char *p, int16_t raw); // Temperatura do MPU6050 com uma casa decimal
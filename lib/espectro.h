@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+#include "lib/ssd1306.h"
+
+// Espectro de vibração por janela: FFT Q15 com Hann de cada eixo do acelerômetro
+// e energia somada dos três eixos em bandas de largura igual (DC excluído).
+// Cada banda sai como RMS em micro-g. Roda no core1, dentro do pipeline.
+#define ESPECTRO_BANDAS_MAX 16
+#define ESPECTRO_REG_MAX 192 // id0 e até 16 bandas de 10 dígitos
+
+void espectro_config(uint32_t n, uint32_t bandas); // n = pontos da janela (0 desliga)
+bool espectro_ativo(void);
+void espectro_imprimir(void);
+size_t espectro_cabecalho(char *dst, size_t tam, uint32_t hz); // "id0,ug_<f0>_<f1>,...\n" com as bordas em Hz
+void espectro_reiniciar(void);                     // core1/core0 antes da captura: descarta a janela parcial
+bool espectro_amostra(const amostra_t *a);         // core1: acumula; true quando uma janela fechou
+size_t espectro_registro(char *dst);               // Última janela: "id0,b0,...\n"
+void espectro_desenhar(ssd1306_t *ssd, uint8_t y0, uint8_t altura); // Barras log2 da última janela
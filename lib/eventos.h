@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fila de eventos do laço principal: ISRs do core0 (botões, serial, sensor,
+// alarme) publicam e o laço dorme em __wfe até haver algo. Cada tipo entra na
+// fila no máximo uma vez: uma rajada vira um evento e a fila nunca transborda.
+typedef enum {
+    EVENTO_SERIAL,    // Chegaram caracteres no stdio; o laço lê todos
+    EVENTO_BOTAO_A,   // Botão A fora da captura
+    EVENTO_BOTAO_B,   // Botão B
+    EVENTO_MOVIMENTO, // INT do sensor fora da captura
+    EVENTO_TEMPO,     // Prazo marcado com eventos_agendar()
+    EVENTO_TIPOS
+} evento_t;
+
+void eventos_iniciar(void);           // core0, uma vez: callback do stdio e um EVENTO_TEMPO inicial
+void eventos_publicar(evento_t e);    // ISR ou core0: enfileira e acorda o laço
+bool eventos_proximo(evento_t *e);    // core0: retira o evento mais antigo; false se não há
+bool eventos_pendentes(void);         // Há evento na fila
+void eventos_agendar(uint32_t ms);    // core0: EVENTO_TEMPO daqui a ms, no lugar do anterior (0 = nenhum)
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Buzzer e LEDs em segundo plano: os padrões viram trechos numa fila que um
+// alarme do timer toca, degrau por degrau, sem prender quem pediu. Tudo no core0.
+#define FEEDBACK_TRECHOS 32 // Trechos de som em espera (potência de 2)
+#define FEEDBACK_WRAP 7812  // Topo do PWM do buzzer: 125 MHz / 32 / 7813 ≈ 500 Hz
+
+#define FEEDBACK_VERDE    1
+#define FEEDBACK_AZUL     2
+#define FEEDBACK_VERMELHO 4
+
+void feedback_iniciar(uint buzzer, uint verde, uint azul, uint vermelho); // core0: PWM do buzzer; LEDs já como saída
+// Bipes como o antigo pwm_beep(): 'vezes' bipes de 'seg' segundos separados por 100 ms,
+// ou rampas de subida e descida em 'seg'; vai para o fim da fila e retorna na hora
+void feedback_beep(float duty, uint8_t vezes, float seg, bool ramp, bool use_end, bool end_high);
+void feedback_leds(uint8_t cores, uint32_t piscar_ms); // Acende as cores (FEEDBACK_*); piscar_ms > 0 alterna com apagado
+bool feedback_tocando(void);                            // Ainda há som na fila
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+// FFT real em ponto fixo Q15, radix-2, para janelas de 16 a FFT_Q15_MAX pontos
+// (potência de 2). Cada estágio divide por 2, então a saída vale X[k] / n e
+// nunca satura; quem chama aproveita a faixa com ponto flutuante de bloco.
+#define FFT_Q15_MAX 512
+
+typedef struct {
+    int16_t re, im;
+} fft_q15_c_t;
+
+int16_t fft_q15_cos(uint32_t k);  // cos(2πk / FFT_Q15_MAX) em Q15
+void fft_q15_hann(int16_t *x, uint32_t n); // Aplica a janela de Hann in-place
+// Transforma n amostras reais de x (destruídas) em n/2 + 1 bins (DC .. Nyquist) em saida
+void fft_q15_real(int16_t *x, uint32_t n, fft_q15_c_t *saida);
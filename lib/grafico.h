@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+#include "lib/ssd1306.h"
+
+// Gráfico ao vivo no OLED durante a captura: x, y e z do acelerômetro ou do
+// giroscópio em três faixas de 16 px. Cada coluna resume as amostras do seu
+// intervalo (mínimo a máximo). Por padrão ('hw') o painel rola a área sozinho
+// com a rolagem contínua (0x27, ligada por 0x2F e parada por 0x2E a cada coluna,
+// depois de um passo) e só a coluna nova atravessa o I2C. '2d' usa o comando de
+// rolagem de uma coluna (0x2D), que nem todo controlador tem; 'sw' rola no buffer
+// e o flush reenvia a área inteira. O botão B alterna as telas durante a captura.
+#define GRAFICO_COLUNA_MS 40 // Intervalo mínimo entre colunas: passa de um passo da rolagem contínua e fica abaixo de dois
+#define GRAFICO_COLUNAS 8    // Colunas prontas à espera de desenho (potência de 2)
+
+typedef enum {
+    TELA_STATS, // Estatísticas da captura
+    TELA_ACC,   // Gráfico do acelerômetro
+    TELA_GYRO,  // Gráfico do giroscópio
+    TELA_MODOS
+} tela_modo_t;
+
+typedef enum {
+    ROLAGEM_CONTINUA, // 0x27 + 0x2F/0x2E, um passo por coluna (padrão)
+    ROLAGEM_COLUNA,   // 0x2D, uma coluna por comando
+    ROLAGEM_BUFFER,   // Só no buffer; o flush reenvia a área
+    ROLAGEM_MODOS
+} grafico_rolagem_t;
+
+typedef struct {
+    uint8_t modo;        // Tela ao iniciar a captura
+    uint32_t escala_mg;  // Fundo de escala do acelerômetro
+    uint32_t escala_dps; // Fundo de escala do giroscópio
+    uint8_t rolagem;     // grafico_rolagem_t
+} grafico_cfg_t;
+
+extern grafico_cfg_t grafico_cfg; // Alterado só com a captura parada
+extern const char *const grafico_telas[TELA_MODOS]; // Nomes usados no comando tela
+extern const char *const grafico_rolagens[ROLAGEM_MODOS]; // hw, 2d, sw
+
+void grafico_imprimir(void);
+void grafico_reiniciar(uint32_t periodo_us); // core0, antes de a captura ficar ativa, com o período real das amostras: tela configurada e colunas zeradas
+void grafico_amostra(const amostra_t *a);    // core1: acumula mínimo e máximo da coluna em andamento
+void grafico_trocar(void);                   // ISR: próxima tela
+tela_modo_t grafico_tela(void);              // Tela escolhida agora
+bool grafico_desenhar(ssd1306_t *ssd);       // core1, com a captura ativa: troca de tela ou uma coluna; true se usou o I2C
+void grafico_parar(ssd1306_t *ssd);          // core1: desliga a rolagem contínua antes de outra tela escrever no painel
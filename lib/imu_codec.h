@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define IMU_BLOCO_TAM 512       // Cada bloco ocupa exatamente um setor do cartão
+#define IMU_BLOCO_MAGIC 0x4D49  // "IM" em little-endian
+#define IMU_BLOCO_VERSAO 2      // v2 acrescenta sessão e CRC; v1 (16 bytes de cabeçalho) ainda é lida
+#define IMU_CAB_V1_TAM 16
+#define IMU_CANAIS_MAX 16       // ax, ay, az, gx, gy, gz, temp e canais derivados
+
+// Cabeçalho de bloco, little-endian. Cada bloco é decodificável sozinho:
+// a primeira amostra vai crua e as demais como delta por canal, zigzag e varint.
+// Sessão, seq e CRC permitem à recuperação distinguir blocos desta gravação de
+// restos antigos no cartão.
+typedef struct __attribute__((packed)) {
+    uint16_t magic;    // IMU_BLOCO_MAGIC
+    uint8_t versao;    // IMU_BLOCO_VERSAO
+    uint8_t canais;    // Canais int16 por amostra
+    uint16_t amostras; // Amostras contidas no bloco
+    uint16_t bytes;    // Bytes úteis após o cabeçalho (o restante é zero)
+    uint32_t seq;      // Número do bloco na sessão (contínuo entre segmentos)
+    uint32_t id0;      // Id da primeira amostra do bloco
+    uint32_t sessao;   // Identificador aleatório da sessão de captura
+    uint16_t crc;      // CRC16-XMODEM do setor inteiro com este campo zerado
+    uint16_t reservado;
+} imu_bloco_cab_t;
+
+// Estado do compressor de um bloco em andamento
+typedef struct {
+    uint8_t *bloco;                    // Setor de destino (IMU_BLOCO_TAM bytes)
+    uint16_t pos;                      // Próximo byte livre
+    uint16_t amostras;                 // Amostras já codificadas
+    uint8_t canais;
+    uint32_t id0;                      // Id da primeira amostra; as seguintes valem id0 + i
+    int16_t anterior[IMU_CANAIS_MAX];  // Última amostra, base dos deltas
+} imu_codec_t;
+
+void imu_codec_iniciar(imu_codec_t *c, uint8_t *bloco, uint8_t canais, uint32_t sessao, uint32_t seq, uint32_t id0); // Abre um bloco vazio
+bool imu_codec_continua(const imu_codec_t *c, uint32_t id);      // false se uma amostra descartada deixaria id fora de id0 + i
+bool imu_codec_adicionar(imu_codec_t *c, const int16_t *amostra); // false se a amostra não cabe mais no bloco
+void imu_codec_finalizar(imu_codec_t *c);                         // Fecha o cabeçalho, zera o restante e calcula o CRC
+// Bloco sem canais cujo payload é texto (ex.: "# calib ...\n"); ocupa um seq como os demais
+void imu_codec_nota(uint8_t *bloco, uint32_t sessao, uint32_t seq, const char *txt, size_t len);
+bool imu_codec_valido(const uint8_t *bloco, imu_bloco_cab_t *cab); // Bloco v2 íntegro (magic e CRC); copia o cabeçalho
+// Decodifica um bloco em amostras (canais int16 consecutivos); retorna a quantidade ou -1 se inválido
+int imu_codec_decodificar(const uint8_t *bloco, int16_t *saida, size_t max_amostras);
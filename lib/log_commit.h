@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Protocolo de confirmação da captura. Os setores de dados vão ao cartão só com
+// f_write; a cada período o log recebe f_sync (FAT e entrada de diretório) e o
+// registro de sessão guarda quantos bytes estão confirmados. Após queda de
+// energia, a perda fica limitada a um período: na montagem o log volta ao
+// tamanho confirmado e, no formato binário, os blocos válidos gravados depois
+// (mesma sessão, seq contínuo, CRC correto) são reincorporados; no CSV o corte
+// cai no último registro completo. O resultado vai para LOG_COMMIT_RELATORIO.
+// Durante a captura o cartão só é acessado pelo servidor de armazenamento (core1);
+// log_commit_recuperar roda na montagem e chama o FatFs direto.
+#define LOG_COMMIT_ARQUIVO "sessao.dat"
+#define LOG_COMMIT_MAGIC 0x53534C44 // "DLSS"
+#define LOG_COMMIT_RELATORIO "recupera.log" // Uma linha por segmento reparado
+#define LOG_COMMIT_PERIODO_MS 1000
+#define LOG_COMMIT_CLMT 64                   // Itens da tabela de fast-seek (até 31 fragmentos)
+
+enum { LOG_SESSAO_FECHADA = 0, LOG_SESSAO_ABERTA = 1 };
+
+// Registro de sessão, regravado no mesmo setor de LOG_COMMIT_ARQUIVO
+typedef struct __attribute__((packed)) {
+    uint32_t magic;    // LOG_COMMIT_MAGIC
+    uint32_t sessao;   // Mesmo valor gravado nos blocos binários
+    uint8_t estado;    // LOG_SESSAO_ABERTA até o fechamento normal
+    uint8_t bin;       // Formato dos segmentos
+    uint16_t reservado;
+    uint32_t tamanho;  // Bytes confirmados em 'nome'
+    char nome[20];     // Segmento em gravação
+    char proximo[20];  // Segmento pré-aberto e ainda vazio ("" se nenhum)
+    uint16_t crc;      // CRC16 dos campos anteriores
+} log_sessao_t;
+
+void log_commit_periodo(uint32_t ms);          // Intervalo entre confirmações
+uint32_t log_commit_periodo_ms(void);
+uint32_t log_commit_abrir(bool bin);           // Abre o registro e sorteia o id da sessão
+void log_commit_segmento(FIL *file, const char *nome, const char *proximo); // Troca de segmento: confirma na hora
+void log_commit_gravado(FIL *file);            // Após cada setor: confirma se o período venceu
+void log_commit_fechar(void);                  // Após fechar os segmentos: marca a sessão como fechada
+void log_commit_recuperar(void);               // Na montagem: repara a sessão que ficou aberta
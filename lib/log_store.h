@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Armazenamento rotativo das capturas: arquivos log_NNNNN.csv/.bin/.res/.esp numerados em
+// ordem crescente. Quando a cota de bytes ou o piso de espaço livre é atingido,
+// os arquivos mais antigos são liberados aos poucos (truncamento em passos e
+// f_unlink). Fora da captura os passos rodam no loop principal; durante ela, no
+// servidor do core1 entre os setores, com o TRIM desligado: o CMD38 pode segurar
+// o volume por segundos. Um passo nunca libera mais que LOG_STORE_PASSO, para
+// não atrasar as gravações que esperam atrás dele.
+#define LOG_STORE_PASSO (1u << 20) // Bytes liberados por passo de recuperação
+#define LOG_STORE_MANTIDOS 4       // Segmento atual, o próximo e os dois auxiliares
+
+void log_store_iniciar(void);                          // Varre o diretório após montar o cartão
+void log_store_encerrar(void);                         // Abandona a recuperação em andamento (antes de desmontar)
+void log_store_nome(char *nome, size_t tam, const char *ext); // Reserva o próximo nome log_NNNNN.ext
+void log_store_manter(const char *nome);               // Protege um log aberto (até LOG_STORE_MANTIDOS; NULL libera todos)
+void log_store_soltar(const char *nome);               // Libera um log protegido depois de fechado
+void log_store_contabilizar(int64_t bytes);            // Ajusta os bytes ocupados pelos logs (reserva, truncamento)
+void log_store_cota(uint32_t cota_mib, uint32_t piso_mib); // 0 desliga o respectivo limite
+bool log_store_recuperar_passo(void);                  // Um passo de recuperação; false se não há nada a liberar
+void log_store_imprimir(void);                         // Ocupação, limites e arquivos removidos
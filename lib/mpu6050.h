@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+#define MPU6050_I2C i2c0   // Barramento do sensor
+#define MPU6050_ADDR 0x68  // Endereço I2C do MPU6050
+#define MPU6050_CANAIS 7   // ax, ay, az, gx, gy, gz, temp (ordem do CSV)
+#define MPU6050_INT_PIN 8  // GPIO ligado ao pino INT do sensor (ativo em nível alto)
+#define AMOSTRA_EXTRAS 4   // Canais derivados no core1 (quaternion do AHRS); 8 bytes a mais por amostra mesmo com o AHRS desligado
+
+// Amostra crua numerada, na ordem das colunas do CSV
+typedef struct {
+    uint32_t id;
+    int16_t canais[MPU6050_CANAIS + AMOSTRA_EXTRAS];
+} amostra_t;
+
+void mpu6050_reset(void);                                                // Reseta e acorda o sensor
+void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp); // Lê aceleração, giroscópio e temperatura
+bool mpu6050_ler_amostra(int16_t canais[MPU6050_CANAIS]);                // Leitura em rajada única de 14 bytes
+void mpu6050_movimento(uint32_t limiar_mg, uint32_t duracao_ms);         // Liga o modo acelerômetro de baixo consumo com interrupção de movimento
+uint32_t mpu6050_drdy(uint32_t hz);                                      // Relógio interno a ~hz com pulso DATA_RDY no INT; retorna a taxa efetiva
+uint32_t mpu6050_drdy_hz(uint32_t hz);                                   // Taxa efetiva que mpu6050_drdy(hz) configuraria (1 kHz / divisor inteiro)
+void mpu6050_drdy_desligar(void);                                        // Desliga o DATA_RDY
+void mpu6050_normal(void);                                               // Volta à medição contínua e desliga a interrupção
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+#include "lib/win_stats.h"
+
+// Pipeline de captura em dois cores:
+//   core0 (ISR do timer)  lê o MPU6050 e empilha amostras na fila SPSC;
+//   core1 (laço display)  formata/comprime as amostras em setores de 512 bytes;
+//   core0 (laço captura)  recebe setores cheios pelo FIFO do SIO e grava no SD.
+// Os índices dos setores gravados voltam ao core1 por uma fila livre de travas.
+#define PIPE_FILA 256      // Amostras em trânsito (potência de 2)
+#define PIPE_SETORES 8     // Buffers de setor; não passa da profundidade do FIFO entre cores
+#define PIPE_SETOR_TAM 512
+#define PIPE_AUX 8         // Registros em trânsito para o arquivo auxiliar (potência de 2)
+
+// Registros de texto que vão para arquivos auxiliares, ao lado do fluxo bruto
+typedef enum {
+    PIPE_AUX_RESUMO,   // win_stats, log_NNNNN.res
+    PIPE_AUX_ESPECTRO, // Bandas do espectro, log_NNNNN.esp
+    PIPE_AUX_TIPOS
+} pipe_aux_tipo_t;
+
+typedef struct {
+    uint8_t tipo;
+    uint16_t len;
+    char txt[WIN_STATS_REG_MAX];
+} pipe_aux_t;
+
+// Quem dita o instante de cada amostra
+typedef enum {
+    PIPE_RELOGIO_TIMER, // repeating_timer do RP2040
+    PIPE_RELOGIO_DRDY   // Pulso DATA_RDY do MPU6050 no pino INT: segue o relógio do próprio sensor
+} pipe_relogio_t;
+
+typedef struct {
+    uint8_t dados[PIPE_SETOR_TAM];
+    uint16_t len;      // Bytes válidos (o último setor de um CSV pode ser parcial)
+    bool fim_segmento; // Último setor do arquivo atual; o seguinte abre o próximo segmento
+} pipe_setor_t;
+
+void pipeline_iniciar(bool bin, uint32_t sessao, uint32_t periodo_us, uint32_t max_amostras); // core0: zera o estado e liga o amostrador (0 = sem limite)
+void pipeline_segmentar(uint32_t max_bytes, uint32_t max_amostras);          // core0, antes de iniciar: limites por arquivo (0 = sem limite)
+void pipeline_relogio(pipe_relogio_t relogio);                              // core0, antes de iniciar: fonte do relógio de amostragem
+pipe_relogio_t pipeline_relogio_atual(void);                                // Fonte configurada
+uint32_t pipeline_periodo_us(uint32_t periodo_us);                          // Período real das amostras com a fonte configurada (o DRDY arredonda a taxa)
+bool pipeline_drdy_irq(void);                                               // ISR do GPIO INT: true se o pulso era do DATA_RDY da captura
+void pipeline_resumo(uint32_t janela, bool so_resumo);                      // core0, antes de iniciar: resumo a cada 'janela' amostras (0 = sem); so_resumo troca o bruto pelos resumos
+const pipe_aux_t *pipeline_proximo_aux(void);                               // Consumidor único (servidor de armazenamento na captura): registro pronto, ou NULL
+void pipeline_liberar_aux(void);                                            // Consumidor: devolve o registro lido
+void pipeline_parar(void);                                                  // core0: para a amostragem; o core1 esvazia o que falta
+void pipeline_interromper(void);                                            // ISR: para a amostragem já; pipeline_parar() desliga o sensor depois
+bool pipeline_proximo_setor(uint32_t timeout_us, pipe_setor_t **setor, bool *ultimo); // core0: setor pronto para gravar
+void pipeline_liberar_setor(pipe_setor_t *setor);                           // core0: devolve o setor ao core1
+bool pipeline_core1_passo(void);                                            // core1: codifica o que houver; true se trabalhou
+bool pipeline_ativo(void);                                                  // Há captura em andamento no pipeline
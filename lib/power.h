@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+#define POWER_REPOUSO_S 60   // Inatividade até o repouso (0 = nunca)
+#define POWER_LIMIAR_MG 40   // Variação de aceleração que acorda o sistema
+
+void power_iniciar(void);                               // core0: pino INT do sensor e relógios mantidos no sono
+void power_config(uint32_t repouso_s, uint32_t limiar_mg); // Ajusta o repouso; 0 s desliga
+void power_imprimir(void);                              // Mostra a configuração no serial
+void power_atividade(void);                             // core0: reinicia a contagem de inatividade
+uint32_t power_verificar(void);                         // core0: entra em repouso se venceu o prazo; ms até ele (0 = nenhum)
+void power_dormir(void);                                // Qualquer core: um __wfe com relógios ociosos cortados
+bool power_tela_ligada(void);                           // core1: o OLED deve ficar aceso?
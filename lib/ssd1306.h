@@ -1,9 +1,17 @@
+#pragma once
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MERGE_GAP 3 // Colunas limpas entre duas corridas sujas que custam menos reenviadas do que uma nova janela
+// Rolagem contínua: uma coluna a cada 3 quadros (código 0b100 do 0x27). Com 0xD5 = 0x80
+// e 0xD9 = 0xF1 o quadro dura 10,4 a 12,7 ms, então o passo leva de 31 a 38 ms
+#define SSD1306_SCROLL_FRAMES_CODE 0x04
+#define SSD1306_SCROLL_STEP_MIN_MS 31
+#define SSD1306_SCROLL_STEP_MAX_MS 38
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -22,7 +30,11 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  SET_SCROLL_LEFT = 0x27,
+  SET_SCROLL_OFF = 0x2E,
+  SET_SCROLL_ON = 0x2F,
+  SET_SCROLL_COL_LEFT = 0x2D
 } ssd1306_command_t;
 
 typedef struct {
@@ -32,12 +44,23 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t *shadow;                          // O que o painel guarda (mesmo layout do ram_buffer)
+  uint8_t *tx_buffer;                       // 0x40 + os bytes de uma janela, coluna a coluna
+  uint8_t dirty[HEIGHT / 8][WIDTH / 8];     // Por página, um bit por coluna tocada desde o último envio
+  bool synced;                              // shadow igual ao painel (false até o primeiro quadro inteiro)
+  bool scrolling;                           // Rolagem contínua ativa: a RAM do painel não aceita escrita
+  uint8_t scroll_p0, scroll_p1;             // Páginas em rolagem
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+size_t ssd1306_flush_dirty(ssd1306_t *ssd); // Envia só as janelas coluna/página que mudaram; retorna os bytes de dados enviados
+size_t ssd1306_send_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1); // Envia uma janela como está
+void ssd1306_scroll_left(ssd1306_t *ssd, uint8_t p0, uint8_t p1, uint8_t x0, uint8_t x1, bool hardware); // Uma coluna para a esquerda; a coluna x1 fica com o conteúdo antigo
+void ssd1306_scroll_start(ssd1306_t *ssd, uint8_t p0, uint8_t p1); // Rolagem contínua para a esquerda (0x27 + 0x2F) das páginas p0..p1 em toda a largura
+void ssd1306_scroll_stop(ssd1306_t *ssd, uint32_t elapsed_ms);   // 0x2E; o modelo avança um passo (elapsed_ms desde o start confirma que foi um só)
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
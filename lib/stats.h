@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "lib/ssd1306.h"
+#include "lib/ui_state.h"
+
+#define STATS_FAIXAS 16        // Faixas log2 dos histogramas de latência (< 1 us .. >= 16 ms)
+#define STATS_JANELA_US 1000000 // Janela de medição da carga por core
+
+// Estatísticas da captura. Cada campo tem um único escritor (um core ou uma ISR),
+// então leituras e escritas de 32 bits são atômicas no M0+ e dispensam travas.
+// O contador de 64 bits é lido por stats_bytes_gravados().
+typedef struct {
+    volatile uint32_t amostras_lidas;            // Amostras adquiridas do MPU6050
+    volatile uint32_t amostras_perdidas;         // Amostras perdidas (prazo estourado, fila cheia ou I2C)
+    volatile uint32_t fila_max;                  // Maior ocupação observada da fila de amostras
+    volatile uint64_t bytes_gravados;            // Bytes aceitos pelo f_write (passa de 4 GiB)
+    volatile uint32_t erros_i2c;                 // Transações I2C com o sensor que falharam
+    volatile uint32_t hist_write[STATS_FAIXAS];  // Latência do f_write em us (faixas log2)
+    volatile uint32_t hist_sync[STATS_FAIXAS];   // Latência do f_sync em us (faixas log2)
+    volatile uint32_t carga_pm[2];               // Ocupação de cada core na última janela (por mil)
+} stats_t;
+
+extern stats_t stats;
+
+void stats_reset(void);                                            // Zera os contadores da sessão de captura
+void stats_latencia(volatile uint32_t hist[STATS_FAIXAS], uint32_t us); // Contabiliza uma latência no histograma
+void stats_fila(uint32_t nivel);                                   // Atualiza o pico de ocupação da fila
+void stats_ocupado(uint32_t us);                                   // Soma tempo ocupado ao core que chama
+uint64_t stats_bytes_gravados(void);                               // Leitura consistente de bytes_gravados
+uint32_t stats_retries_sd(void);                                   // Total de comandos SD reenviados
+void stats_imprimir(void);                                         // Imprime todas as estatísticas no serial
+void stats_publicar(void);                                         // core0: instantâneo dos contadores para o OLED (ui_telemetria)
+void stats_desenhar(ssd1306_t *ssd, const ui_telemetria_t *t);     // core1: desenha a página compacta a partir do instantâneo
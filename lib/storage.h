@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Servidor de armazenamento no core1: o cartão atende pedidos que o core0
+// enfileira sem travas e sem esperar. A conclusão volta por um callback que
+// roda no core0, dentro de storage_concluir(), na ordem dos pedidos. Pedidos
+// longos (listagem, exibição de arquivo) avançam um passo por vez, intercalados
+// com a codificação da captura, que também segue enquanto o cartão está ocupado.
+// Durante a captura todo acesso ao cartão passa por aqui: se o core0 chamasse o
+// FatFs, o core1 esperaria pela trava do volume com amostras na fila.
+#define STORAGE_FILA 16      // Pedidos em trânsito (potência de 2)
+#define STORAGE_NOME_MAX 64
+#define STORAGE_LINHA_MAX 256 // Maior linha impressa por passo de STORAGE_MOSTRAR
+
+typedef enum {
+    STORAGE_ANEXAR,      // f_write de len bytes de dados em fil, na posição atual
+    STORAGE_ABRIR,       // f_open de nome em fil, modo FA_* em len
+    STORAGE_FECHAR,      // f_close de fil
+    STORAGE_SINCRONIZAR, // f_sync de fil
+    STORAGE_LER,         // Até len bytes de nome a partir de pos, em dados
+    STORAGE_LISTAR,      // Imprime o diretório nome ("" = atual)
+    STORAGE_MOSTRAR,     // Imprime o arquivo nome
+    STORAGE_ESPACO,      // Espaço livre e total do drive nome, em KiB
+    STORAGE_CHAMAR       // fn(pedido) no core1: operações compostas (reserva, confirmação, arquivos auxiliares)
+} storage_op_t;
+
+typedef struct storage_pedido storage_pedido_t;
+typedef void (*storage_cb_t)(const storage_pedido_t *p);
+typedef FRESULT (*storage_fn_t)(storage_pedido_t *p);
+
+struct storage_pedido {
+    uint8_t op;
+    FRESULT res;                 // Preenchido pelo servidor
+    FIL *fil;
+    void *dados;
+    uint32_t len;
+    uint32_t pos;
+    uint32_t n;                  // Bytes gravados ou lidos; ESPACO: KiB livres
+    uint32_t total;              // ESPACO: KiB do volume
+    storage_fn_t fn;             // CHAMAR: roda no core1; o retorno vai para res
+    storage_cb_t cb;             // Opcional, chamado no core0 com uma cópia do pedido concluído
+    void *ctx;                   // Livre para o cliente
+    char nome[STORAGE_NOME_MAX]; // Arquivo, diretório ou drive
+};
+
+void storage_iniciar(void);                     // core1, uma vez: codifica amostras enquanto o cartão está ocupado
+bool storage_passo(void);                       // core1: atende um pedido ou um passo dele; true se trabalhou
+void storage_enviar(const storage_pedido_t *p); // core0: enfileira uma cópia; só espera se a fila estiver cheia
+void storage_anexar(FIL *fil, const void *dados, uint32_t len, storage_cb_t cb, void *ctx); // core0: atalho de STORAGE_ANEXAR
+FRESULT storage_chamar(storage_fn_t fn, void *ctx); // core0: roda fn no core1 e espera o resultado (callbacks pendentes rodam enquanto isso)
+void storage_concluir(void);                    // core0: entrega os pedidos concluídos aos callbacks
+void storage_esperar(void);                     // core0: aguarda todos os pedidos e seus callbacks
+uint32_t storage_pendentes(void);               // Pedidos enviados cujo callback ainda não rodou
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+
+// Captura por evento: o detector roda sobre todas as amostras no core1 e um
+// histórico circular em RAM guarda os instantes anteriores ao disparo.
+#define TRIGGER_PRE_MAX 1024   // Capacidade do histórico (amostras, potência de 2)
+#define TRIGGER_1G 16384       // LSB por g na escala de ±2 g
+#define TRIGGER_STA_SHIFT 3    // Média curta: ~8 amostras
+#define TRIGGER_LTA_SHIFT 8    // Média longa: ~256 amostras
+#define TRIGGER_BASE_SHIFT 9   // Linha de base por eixo (remove a gravidade)
+#define TRIGGER_PISO 8         // Nível mínimo da LTA em LSB; evita disparos no ruído de repouso
+
+typedef enum {
+    TRIGGER_DESLIGADO = 0, // Grava tudo
+    TRIGGER_LIMIAR,        // |a| se afasta de 1 g mais que limiar_mg
+    TRIGGER_STALTA,        // Razão STA/LTA da aceleração sem a gravidade passa de razao_x10 / 10
+} trigger_modo_t;
+
+typedef struct {
+    trigger_modo_t modo;
+    uint32_t limiar_mg;
+    uint32_t razao_x10;
+    uint32_t pre; // Amostras anteriores ao disparo gravadas no evento (até TRIGGER_PRE_MAX)
+    uint32_t pos; // Amostras gravadas após o último disparo
+} trigger_cfg_t;
+
+extern trigger_cfg_t trigger_cfg; // Alterado só com a captura parada
+
+void trigger_reiniciar(void);              // Zera detector e histórico
+bool trigger_amostra(const amostra_t *a);  // Guarda no histórico e avalia; true = dispara
+const amostra_t *trigger_historico(void);  // Amostra mais antiga ainda não gravada (NULL se vazio)
+void trigger_descartar(void);              // Remove a mais antiga do histórico
+void trigger_limpar_historico(void);       // Após um evento: nada do que já foi gravado se repete
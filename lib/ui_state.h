@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estado da interface entre os cores: o core0 publica, o core1 desenha.
+// Seqlock: a geração é ímpar durante a escrita e avança 2 a cada publicação;
+// o leitor nunca espera, só descarta a cópia que pegou uma escrita no meio e
+// tenta de novo quando o __sev do escritor o acordar.
+#define UI_TEXTO_MAX 120
+
+typedef struct {
+    bool alteracao;            // Mensagem de estado no meio da tela em vez do menu
+    char texto[UI_TEXTO_MAX];
+} ui_estado_t;
+
+// Contadores da captura para a página de estatísticas, num instantâneo coerente
+// (lidas, perdidas e bytes do mesmo momento). Ângulos do AHRS e bandas do espectro
+// já são calculados no core1, que os desenha sem cruzar de core.
+typedef struct {
+    uint32_t amostras_lidas;
+    uint32_t amostras_perdidas;
+    uint64_t bytes_gravados;
+    uint32_t erros_i2c;
+    uint32_t retries_sd;
+    uint32_t carga_pm[2];
+} ui_telemetria_t;
+
+void ui_mostrar(bool alteracao, const char *texto); // core0, único escritor
+bool ui_ler(ui_estado_t *copia, uint32_t *geracao); // core1: true com cópia consistente se a geração mudou desde *geracao
+void ui_telemetria(const ui_telemetria_t *t);       // core0, único escritor, pelo mesmo seqlock com geração própria
+bool ui_ler_telemetria(ui_telemetria_t *copia, uint32_t *geracao); // core1: como ui_ler
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lib/mpu6050.h"
+
+// Resumo por janela de cada canal: mínimo, máximo, média, RMS e variância, em
+// unidades cruas do sensor. Só somas inteiras (soma e soma dos quadrados), exatas
+// enquanto a janela tiver até WIN_STATS_MAX amostras.
+#define WIN_STATS_MAX 65535u
+#define WIN_STATS_REG_MAX 320 // Maior registro: id, n e 7 canais x 5 campos
+
+typedef struct {
+    uint32_t id0;                      // Primeira amostra da janela
+    uint32_t n;                        // Amostras acumuladas
+    int16_t min[MPU6050_CANAIS], max[MPU6050_CANAIS];
+    int64_t soma[MPU6050_CANAIS];
+    uint64_t quad[MPU6050_CANAIS];
+} win_stats_t;
+
+extern const char win_stats_cabecalho[]; // Linha de cabeçalho do arquivo de resumos
+
+void win_stats_zerar(win_stats_t *w);
+void win_stats_adicionar(win_stats_t *w, const amostra_t *a);
+size_t win_stats_registro(const win_stats_t *w, char *dst); // Formata "id0,n,<min,max,media,rms,var> x 7\n"
@@ -0,0 +1,237 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "crc.h"
+#include "lib/log_commit.h"
+#include "lib/imu_codec.h"
+#include "lib/stats.h"
+#include "lib/storage.h"
+
+// O registro e o arquivo de sessão só são tocados no core1, dentro do servidor de
+// armazenamento; o core0 só enfileira pedidos e mede o período
+static FIL arq_sessao;
+static log_sessao_t reg;
+static bool aberto;
+static uint32_t periodo_us = LOG_COMMIT_PERIODO_MS * 1000;
+static uint32_t ultimo_commit;
+
+void log_commit_periodo(uint32_t ms){
+    periodo_us = ms * 1000;
+}
+
+uint32_t log_commit_periodo_ms(void){
+    return periodo_us / 1000;
+}
+
+static FRESULT registro_gravar(void){
+    reg.crc = crc16((const char *)&reg, offsetof(log_sessao_t, crc));
+    UINT bw;
+    FRESULT fr = f_lseek(&arq_sessao, 0);
+    if (fr == FR_OK) fr = f_write(&arq_sessao, &reg, sizeof(reg), &bw);
+    if (fr == FR_OK) fr = f_sync(&arq_sessao);
+    return fr;
+}
+
+static bool registro_ler(FIL *file, log_sessao_t *r){
+    UINT br;
+    return f_read(file, r, sizeof(*r), &br) == FR_OK && br == sizeof(*r) &&
+           r->magic == LOG_COMMIT_MAGIC &&
+           r->crc == crc16((const char *)r, offsetof(log_sessao_t, crc));
+}
+
+static FRESULT abrir_srv(storage_pedido_t *p){
+    memset(&reg, 0, sizeof(reg));
+    reg.magic = LOG_COMMIT_MAGIC;
+    reg.sessao = p->pos;
+    reg.bin = (uint8_t)p->len;
+    FRESULT fr = f_open(&arq_sessao, LOG_COMMIT_ARQUIVO, FA_WRITE | FA_OPEN_ALWAYS);
+    aberto = fr == FR_OK;
+    return fr;
+}
+
+uint32_t log_commit_abrir(bool bin){
+    storage_pedido_t p = {.op = STORAGE_CHAMAR, .fn = abrir_srv, .len = bin, .pos = get_rand_32()};
+    storage_enviar(&p); // Os pedidos seguintes já encontram o registro aberto
+    ultimo_commit = time_us_32();
+    return p.pos;
+}
+
+// f_sync do log e depois o registro: o tamanho registrado nunca passa do que está no cartão
+static FRESULT confirmar(FIL *file){
+    uint32_t t0 = time_us_32();
+    FRESULT fr = f_sync(file);
+    if (fr == FR_OK && aberto){
+        reg.tamanho = (uint32_t)f_tell(file);
+        fr = registro_gravar();
+    }
+    stats_latencia(stats.hist_sync, time_us_32() - t0);
+    return fr;
+}
+
+static FRESULT confirmar_srv(storage_pedido_t *p){
+    return confirmar(p->fil);
+}
+
+// Troca de segmento: os nomes viajam no pedido porque o registro é do core1
+static FRESULT segmento_srv(storage_pedido_t *p){
+    reg.estado = LOG_SESSAO_ABERTA;
+    snprintf(reg.nome, sizeof(reg.nome), "%s", p->nome);
+    snprintf(reg.proximo, sizeof(reg.proximo), "%s", (const char *)p->ctx);
+    return confirmar(p->fil);
+}
+
+void log_commit_segmento(FIL *file, const char *nome, const char *proximo){
+    storage_pedido_t p = {.op = STORAGE_CHAMAR, .fn = segmento_srv, .fil = file, .ctx = (void *)(proximo ? proximo : "")};
+    snprintf(p.nome, sizeof(p.nome), "%s", nome);
+    storage_enviar(&p);
+    storage_esperar(); // O chamador fecha o segmento logo depois
+    ultimo_commit = time_us_32();
+}
+
+void log_commit_gravado(FIL *file){
+    if (time_us_32() - ultimo_commit < periodo_us) return;
+    // Entra na fila atrás dos setores já entregues: confirma exatamente o que foi gravado
+    storage_pedido_t p = {.op = STORAGE_CHAMAR, .fn = confirmar_srv, .fil = file};
+    storage_enviar(&p);
+    ultimo_commit = time_us_32();
+}
+
+static FRESULT fechar_srv(storage_pedido_t *p){
+    if (!aberto) return FR_OK;
+    reg.estado = LOG_SESSAO_FECHADA;
+    FRESULT fr = registro_gravar();
+    f_close(&arq_sessao);
+    aberto = false;
+    return fr;
+}
+
+void log_commit_fechar(void){
+    storage_chamar(fechar_srv, NULL);
+}
+
+// Lê o bloco em 'pos'; 'valido' diz se ele é íntegro. Erro de leitura volta como FRESULT
+static FRESULT bloco_em(FIL *file, FSIZE_t pos, uint8_t *bloco, imu_bloco_cab_t *cab, bool *valido){
+    UINT br;
+    *valido = false;
+    FRESULT fr = f_lseek(file, pos);
+    if (fr == FR_OK) fr = f_read(file, bloco, IMU_BLOCO_TAM, &br);
+    if (fr == FR_OK) *valido = br == IMU_BLOCO_TAM && imu_codec_valido(bloco, cab);
+    return fr;
+}
+
+// Último '\n' antes de 'fim' em 'corte' (0 se nenhum): a cauda do CSV é lida de trás
+// para frente, setor a setor
+static FRESULT ultima_linha(FIL *file, FSIZE_t fim, uint8_t *buf, FSIZE_t *corte){
+    *corte = 0;
+    while (fim > 0){
+        FSIZE_t ini = fim > IMU_BLOCO_TAM ? fim - IMU_BLOCO_TAM : 0;
+        UINT br;
+        FRESULT fr = f_lseek(file, ini);
+        if (fr == FR_OK) fr = f_read(file, buf, (UINT)(fim - ini), &br);
+        if (fr == FR_OK && br != fim - ini) fr = FR_INT_ERR; // Menor que o tamanho do arquivo
+        if (fr != FR_OK) return fr;
+        for (UINT i = br; i > 0; i--){
+            if (buf[i - 1] == '\n'){
+                *corte = ini + i;
+                return FR_OK;
+            }
+        }
+        fim = ini;
+    }
+    return FR_OK;
+}
+
+// Repara um segmento. Binário: parte do tamanho confirmado e avança enquanto houver
+// blocos íntegros da mesma sessão com seq contínuo. CSV: corta no último registro
+// completo dentro do trecho confirmado. Só a cauda é lida, com fast-seek. Se a
+// leitura falhar o arquivo fica como está: truncar sem ter lido apagaria dados bons.
+static void recuperar_segmento(const log_sessao_t *r, const char *nome, FSIZE_t confirmado, FIL *relatorio){
+    static uint8_t bloco[IMU_BLOCO_TAM];
+    static DWORD clmt[LOG_COMMIT_CLMT];
+    FIL file;
+    uint32_t t0 = time_us_32();
+    if (f_open(&file, nome, FA_READ | FA_WRITE) != FR_OK) return;
+    FSIZE_t alocado = f_size(&file); // Reserva do f_expand ou tamanho do último f_sync
+    if (confirmado > alocado) confirmado = alocado;
+
+    // Mapa de clusters montado uma vez; cada f_lseek na cauda passa a ser O(1)
+    clmt[0] = LOG_COMMIT_CLMT;
+    file.cltbl = clmt;
+    if (f_lseek(&file, CREATE_LINKMAP) != FR_OK) file.cltbl = NULL; // Muito fragmentado: seek normal
+
+    FSIZE_t fim = confirmado;
+    FRESULT fr = FR_OK;
+    if (r->bin){
+        imu_bloco_cab_t cab;
+        bool tem_base = false, valido;
+        uint32_t prox_seq = 0;
+        fim -= fim % IMU_BLOCO_TAM;
+        if (fim >= IMU_BLOCO_TAM){
+            fr = bloco_em(&file, fim - IMU_BLOCO_TAM, bloco, &cab, &valido);
+            if (fr == FR_OK && valido && cab.sessao == r->sessao){
+                tem_base = true;
+                prox_seq = cab.seq + 1;
+            }
+        }
+        while (fr == FR_OK && fim + IMU_BLOCO_TAM <= alocado){
+            fr = bloco_em(&file, fim, bloco, &cab, &valido);
+            if (fr != FR_OK || !valido || cab.sessao != r->sessao || (tem_base && cab.seq != prox_seq)) break;
+            tem_base = true;
+            prox_seq = cab.seq + 1;
+            fim += IMU_BLOCO_TAM;
+        }
+    } else {
+        fr = ultima_linha(&file, fim, bloco, &fim);
+    }
+    file.cltbl = NULL; // f_truncate exige o modo de seek normal
+    if (fr == FR_OK) fr = f_lseek(&file, fim);
+    if (fr == FR_OK) fr = f_truncate(&file);
+    f_close(&file);
+    if (fr == FR_OK && fim == 0) f_unlink(nome); // Segmento que não chegou a receber dados
+
+    char linha[128];
+    int n;
+    if (fr != FR_OK)
+        n = snprintf(linha, sizeof(linha), "sessao %08lx: %s mantido, erro %d na leitura da cauda\n",
+                     (unsigned long)r->sessao, nome, fr);
+    else if (fim == 0)
+        n = snprintf(linha, sizeof(linha), "sessao %08lx: %s vazio, removido\n", (unsigned long)r->sessao, nome);
+    else
+        n = snprintf(linha, sizeof(linha), "sessao %08lx: %s com %lu bytes (confirmados %lu, %+ld na cauda, %lu descartados) em %lu ms\n",
+                     (unsigned long)r->sessao, nome, (unsigned long)fim, (unsigned long)confirmado,
+                     (long)(fim - confirmado), (unsigned long)(alocado - fim),
+                     (unsigned long)((time_us_32() - t0) / 1000));
+    if (n < 0) return;
+    if (n >= (int)sizeof(linha)){ // Cortada pelo snprintf: grava só o que coube, ainda terminado em '\n'
+        n = sizeof(linha) - 1;
+        linha[n - 1] = '\n';
+    }
+    printf("[INFO] Recuperação: %s", linha);
+    UINT bw;
+    if (relatorio) f_write(relatorio, linha, (UINT)n, &bw);
+}
+
+void log_commit_recuperar(void){
+    FIL file;
+    log_sessao_t r;
+    if (f_open(&file, LOG_COMMIT_ARQUIVO, FA_READ | FA_WRITE) != FR_OK) return;
+    if (!registro_ler(&file, &r) || r.estado != LOG_SESSAO_ABERTA){
+        f_close(&file);
+        return;
+    }
+    printf("[INFO] Sessão %08lx não foi fechada; reparando logs.\n", (unsigned long)r.sessao);
+    static FIL relatorio; // Histórico das recuperações, só acrescentado
+    bool com_relatorio = f_open(&relatorio, LOG_COMMIT_RELATORIO, FA_WRITE | FA_OPEN_APPEND) == FR_OK;
+    if (r.nome[0]) recuperar_segmento(&r, r.nome, r.tamanho, com_relatorio ? &relatorio : NULL);
+    if (r.proximo[0]) recuperar_segmento(&r, r.proximo, 0, com_relatorio ? &relatorio : NULL);
+    if (com_relatorio) f_close(&relatorio);
+
+    r.estado = LOG_SESSAO_FECHADA;
+    r.crc = crc16((const char *)&r, offsetof(log_sessao_t, crc));
+    UINT bw;
+    f_lseek(&file, 0);
+    f_write(&file, &r, sizeof(r), &bw);
+    f_close(&file);
+}
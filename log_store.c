@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "lib/log_store.h"
+
+static bool pronto;                 // Diretório varrido com o cartão montado
+static uint32_t menor, proximo;     // Índice do log mais antigo e do próximo a criar
+static int64_t usados;              // Bytes ocupados pelos logs (reservas incluídas)
+static uint64_t cota, piso;         // Limites em bytes; 0 = desligado
+static uint32_t removidos;          // Arquivos apagados desde a montagem
+
+// Log em recuperação: encolhe LOG_STORE_PASSO por vez até ser apagado
+static FIL alvo;
+static bool alvo_aberto;
+static char alvo_nome[20];
+static char mantido[LOG_STORE_MANTIDOS][20]; // Logs abertos que não podem ser recuperados (segmentos e auxiliares da captura)
+
+static const char *const extensoes[] = {"csv", "bin", "res", "esp"};
+#define N_EXT (sizeof(extensoes) / sizeof(extensoes[0]))
+
+static bool indice_do_nome(const char *nome, uint32_t *indice){
+    if (strncmp(nome, "log_", 4) != 0) return false;
+    char *fim;
+    unsigned long v = strtoul(nome + 4, &fim, 10);
+    if (fim == nome + 4 || *fim != '.') return false;
+    for (size_t i = 0; i < N_EXT; i++){
+        if (strcmp(fim + 1, extensoes[i]) == 0){
+            *indice = (uint32_t)v;
+            return true;
+        }
+    }
+    return false;
+}
+
+void log_store_iniciar(void){
+    DIR dj;
+    FILINFO fno;
+    menor = UINT32_MAX;
+    proximo = 0;
+    usados = 0;
+    removidos = 0;
+    alvo_aberto = false;
+    FRESULT fr = f_findfirst(&dj, &fno, "", "log_*");
+    while (fr == FR_OK && fno.fname[0]){
+        uint32_t i;
+        if (!(fno.fattrib & AM_DIR) && indice_do_nome(fno.fname, &i)){
+            if (i < menor) menor = i;
+            if (i >= proximo) proximo = i + 1;
+            usados += fno.fsize;
+        }
+        fr = f_findnext(&dj, &fno);
+    }
+    f_closedir(&dj);
+    if (menor == UINT32_MAX) menor = proximo;
+    // Primeira chamada pode varrer a FAT inteira; depois o FatFs mantém o total em cache
+    DWORD livres;
+    FATFS *fs;
+    f_getfree("", &livres, &fs);
+    pronto = true;
+}
+
+void log_store_encerrar(void){
+    if (alvo_aberto) f_close(&alvo);
+    alvo_aberto = false;
+    pronto = false;
+}
+
+void log_store_nome(char *nome, size_t tam, const char *ext){
+    if (!pronto) log_store_iniciar();
+    snprintf(nome, tam, "log_%05lu.%s", (unsigned long)proximo++, ext);
+}
+
+void log_store_manter(const char *nome){
+    for (int i = 0; i < LOG_STORE_MANTIDOS; i++){
+        if (!nome)
+            mantido[i][0] = '\0';
+        else if (!mantido[i][0]){
+            snprintf(mantido[i], sizeof(mantido[i]), "%s", nome);
+            return;
+        }
+    }
+}
+
+void log_store_soltar(const char *nome){
+    for (int i = 0; i < LOG_STORE_MANTIDOS; i++)
+        if (strcmp(mantido[i], nome) == 0) mantido[i][0] = '\0';
+}
+
+static bool em_uso(const char *nome){
+    for (int i = 0; i < LOG_STORE_MANTIDOS; i++)
+        if (strcmp(nome, mantido[i]) == 0) return true;
+    return false;
+}
+
+void log_store_contabilizar(int64_t bytes){
+    usados += bytes;
+}
+
+void log_store_cota(uint32_t cota_mib, uint32_t piso_mib){
+    cota = (uint64_t)cota_mib << 20;
+    piso = (uint64_t)piso_mib << 20;
+}
+
+static bool acima_do_limite(void){
+    if (cota && usados > (int64_t)cota) return true;
+    if (piso){
+        DWORD livres;
+        FATFS *fs;
+        if (f_getfree("", &livres, &fs) == FR_OK &&
+            (uint64_t)livres * fs->csize * FF_MIN_SS < piso) return true;
+    }
+    return false;
+}
+
+// Abre o log mais antigo que não esteja em uso; os dois últimos nomes
+// reservados (segmento atual e o próximo) nunca são tocados
+static bool alvo_abrir(void){
+    while (menor + 2 < proximo){
+        // Também reconhece os nomes antigos de três dígitos (log_NNN)
+        for (size_t i = 0; i < 2 * N_EXT; i++){
+            snprintf(alvo_nome, sizeof(alvo_nome), i < N_EXT ? "log_%05lu.%s" : "log_%03lu.%s",
+                     (unsigned long)menor, extensoes[i % N_EXT]);
+            if (em_uso(alvo_nome)) continue;
+            if (f_open(&alvo, alvo_nome, FA_WRITE | FA_OPEN_EXISTING) == FR_OK){
+                alvo_aberto = true;
+                return true;
+            }
+        }
+        menor++; // Índice vago
+    }
+    return false;
+}
+
+bool log_store_recuperar_passo(void){
+    if (!pronto || !acima_do_limite()) return false;
+    if (!alvo_aberto && !alvo_abrir()) return false;
+
+    FSIZE_t tam = f_size(&alvo);
+    if (tam > LOG_STORE_PASSO){
+        // Libera só a cauda: cada passo mexe em poucos clusters da FAT (e no TRIM deles)
+        if (f_lseek(&alvo, tam - LOG_STORE_PASSO) != FR_OK || f_truncate(&alvo) != FR_OK ||
+            f_sync(&alvo) != FR_OK){
+            f_close(&alvo);
+            alvo_aberto = false;
+            menor++; // Não insiste num arquivo com erro
+            return false;
+        }
+        usados -= LOG_STORE_PASSO;
+        return true;
+    }
+    f_close(&alvo);
+    alvo_aberto = false;
+    if (f_unlink(alvo_nome) == FR_OK){
+        usados -= tam;
+        removidos++;
+        printf("[INFO] Log antigo %s removido para liberar espaço.\n", alvo_nome);
+    }
+    menor++;
+    return true;
+}
+
+void log_store_imprimir(void){
+    printf("Logs: %lu KiB em uso", (unsigned long)(usados > 0 ? usados >> 10 : 0));
+    if (pronto) printf(", índices %05lu..%05lu", (unsigned long)menor, (unsigned long)(proximo ? proximo - 1 : 0));
+    printf("\nCota: ");
+    if (cota) printf("%lu MiB", (unsigned long)(cota >> 20)); else printf("desligada");
+    printf(", piso livre: ");
+    if (piso) printf("%lu MiB", (unsigned long)(piso >> 20)); else printf("desligado");
+    printf("\nRemovidos desde a montagem: %lu\n", (unsigned long)removidos);
+}
@@ -0,0 +1,116 @@
+#include "pico/stdlib.h"
+#include "lib/mpu6050.h"
+#include "lib/stats.h"
+
+// Registradores usados pela detecção de movimento e pelo DATA_RDY
+#define REG_SMPLRT_DIV 0x19  // Taxa = 1 kHz / (1 + div) com o DLPF ligado
+#define REG_CONFIG 0x1A
+#define REG_ACCEL_CONFIG 0x1C
+#define REG_MOT_THR 0x1F     // 1 LSB = 2 mg
+#define REG_MOT_DUR 0x20     // 1 LSB = 1 ms
+#define REG_INT_PIN_CFG 0x37
+#define REG_INT_ENABLE 0x38
+#define REG_INT_STATUS 0x3A
+#define REG_PWR_MGMT_1 0x6B
+#define REG_PWR_MGMT_2 0x6C
+
+static void escreve(uint8_t reg, uint8_t val){
+    uint8_t buf[] = {reg, val};
+    if (i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, buf, 2, false) < 0) stats.erros_i2c++;
+}
+
+void mpu6050_reset(void){
+    uint8_t buf[] = {0x6B, 0x80};
+    i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, buf, 2, false);
+    sleep_ms(100);
+    buf[1] = 0x00;
+    i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, buf, 2, false);
+    sleep_ms(10);
+}
+
+void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp){
+    uint8_t buffer[6];
+    uint8_t val = 0x3B;
+    if (i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, &val, 1, true) < 0 ||
+        i2c_read_blocking(MPU6050_I2C, MPU6050_ADDR, buffer, 6, false) < 0) stats.erros_i2c++;
+    for (int i = 0; i < 3; i++)
+        accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+
+    val = 0x43;
+    if (i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, &val, 1, true) < 0 ||
+        i2c_read_blocking(MPU6050_I2C, MPU6050_ADDR, buffer, 6, false) < 0) stats.erros_i2c++;
+    for (int i = 0; i < 3; i++)
+        gyro[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+
+    val = 0x41;
+    if (i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, &val, 1, true) < 0 ||
+        i2c_read_blocking(MPU6050_I2C, MPU6050_ADDR, buffer, 2, false) < 0) stats.erros_i2c++;
+    *temp = (buffer[0] << 8) | buffer[1];
+}
+
+bool mpu6050_ler_amostra(int16_t canais[MPU6050_CANAIS]){
+    // 0x3B..0x48: ACCEL_XYZ, TEMP, GYRO_XYZ em uma única transação
+    uint8_t buffer[14];
+    uint8_t val = 0x3B;
+    if (i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, &val, 1, true) < 0 ||
+        i2c_read_blocking(MPU6050_I2C, MPU6050_ADDR, buffer, 14, false) < 0){
+        stats.erros_i2c++;
+        return false;
+    }
+    for (int i = 0; i < 3; i++){
+        canais[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];        // Aceleração
+        canais[i + 3] = (buffer[8 + i * 2] << 8) | buffer[9 + i * 2];  // Giroscópio
+    }
+    canais[6] = (buffer[6] << 8) | buffer[7];                          // Temperatura
+    return true;
+}
+
+void mpu6050_movimento(uint32_t limiar_mg, uint32_t duracao_ms){
+    uint32_t thr = (limiar_mg + 1) / 2;
+    uint32_t dur = duracao_ms;
+    escreve(REG_ACCEL_CONFIG, 0x01);      // ±2 g, passa-altas de 5 Hz: só a variação conta, não a gravidade
+    escreve(REG_MOT_THR, thr > 255 ? 255 : (uint8_t)(thr ? thr : 1));
+    escreve(REG_MOT_DUR, dur > 255 ? 255 : (uint8_t)(dur ? dur : 1));
+    escreve(REG_INT_PIN_CFG, 0x30);       // Nível alto, push-pull, retido até qualquer leitura
+    escreve(REG_INT_ENABLE, 0x40);        // MOT_EN
+    // Ciclo de baixo consumo: só o acelerômetro acorda a 5 Hz; giroscópio e temperatura em espera
+    escreve(REG_PWR_MGMT_2, (1u << 6) | 0x07);
+    escreve(REG_PWR_MGMT_1, 0x28);        // CYCLE + TEMP_DIS
+}
+
+void mpu6050_normal(void){
+    escreve(REG_PWR_MGMT_1, 0x00);
+    escreve(REG_PWR_MGMT_2, 0x00);
+    escreve(REG_INT_ENABLE, 0x00);
+    escreve(REG_ACCEL_CONFIG, 0x00);
+    uint8_t reg = REG_INT_STATUS, status;
+    i2c_write_blocking(MPU6050_I2C, MPU6050_ADDR, &reg, 1, true); // Solta o pino INT retido
+    i2c_read_blocking(MPU6050_I2C, MPU6050_ADDR, &status, 1, false);
+    sleep_ms(30); // Giroscópio estabiliza antes da próxima captura
+}
+
+// SMPLRT_DIV para ~hz a partir do relógio de 1 kHz
+static uint32_t drdy_divisor(uint32_t hz){
+    uint32_t div = hz ? 1000 / hz : 256;
+    div = div < 1 ? 0 : div - 1;
+    return div > 255 ? 255 : div;
+}
+
+uint32_t mpu6050_drdy_hz(uint32_t hz){
+    return 1000 / (drdy_divisor(hz) + 1);
+}
+
+uint32_t mpu6050_drdy(uint32_t hz){
+    uint32_t div = drdy_divisor(hz);
+    escreve(REG_CONFIG, 0x01);            // DLPF de 184 Hz: o relógio de amostras passa a 1 kHz
+    escreve(REG_SMPLRT_DIV, (uint8_t)div);
+    escreve(REG_INT_PIN_CFG, 0x10);       // Pulso de 50 us, nível alto, limpo por qualquer leitura
+    escreve(REG_INT_ENABLE, 0x01);        // DATA_RDY_EN
+    return 1000 / (div + 1);
+}
+
+void mpu6050_drdy_desligar(void){
+    escreve(REG_INT_ENABLE, 0x00);
+    escreve(REG_SMPLRT_DIV, 0x00);
+    escreve(REG_CONFIG, 0x00);
+}
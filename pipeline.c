@@ -0,0 +1,465 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "lib/pipeline.h"
+#include "lib/csv_fmt.h"
+#include "lib/imu_codec.h"
+#include "lib/stats.h"
+#include "lib/trigger.h"
+#include "lib/espectro.h"
+#include "lib/calib.h"
+#include "lib/ahrs.h"
+#include "lib/grafico.h"
+
+#define PIPE_ULTIMO 0x80000000u // Marca no FIFO: último setor da captura
+
+static const char cabecalho_csv[] = "id,ax,ay,az,gx,gy,gz,temp";
+
+// Fila de amostras: escrita só pela ISR do amostrador (core0), lida só pelo core1
+static amostra_t fila[PIPE_FILA];
+static volatile uint32_t fila_cabeca, fila_cauda;
+
+// Setores e fila de setores livres: core0 devolve, core1 consome
+static pipe_setor_t setores[PIPE_SETORES];
+static volatile uint8_t livres[PIPE_SETORES];
+static volatile uint32_t livres_cabeca, livres_cauda;
+
+static repeating_timer_t timer_amostras;
+static pipe_relogio_t relogio = PIPE_RELOGIO_TIMER;
+static volatile bool drdy_ligado; // Pulsos do INT pertencem ao amostrador
+static volatile bool ativo;       // core0 liga; core1 desliga ao emitir o último setor
+static volatile bool amostrando;  // Amostrador ainda pode empilhar amostras
+static uint32_t slots, max_slots; // Só a ISR do amostrador mexe
+static uint32_t seg_max_bytes, seg_max_amostras;
+
+// Estado do codificador, exclusivo do core1 enquanto 'ativo'
+static bool formato_bin;
+static uint8_t canais;         // Sensor e, com o AHRS, o quaternion
+static pipe_setor_t *atual;
+static uint16_t pos;
+static imu_codec_t codec;
+static bool codec_aberto;
+static uint32_t seq, sessao_atual;
+static char linha[CSV_REG_MAX + AHRS_CANAIS * 7]; // Registro que atravessa o fim do setor
+static char cabecalho_txt[CALIB_TXT_MAX + WIN_STATS_REG_MAX]; // Calibração + colunas (o maior cabeçalho cabe em um registro)
+static bool nota_pendente;   // Bloco de calibração ainda não emitido no segmento binário
+static const char *pendente; // Texto ainda não copiado para o setor
+static size_t pendente_len;
+static uint32_t seg_bytes, seg_amostras; // Ocupação do segmento em andamento
+static bool por_evento;        // Só grava em torno dos disparos do trigger
+static bool em_evento;         // Janela pós-disparo em andamento
+static bool fim_evento;        // Evento encerrado: fecha o arquivo antes da próxima amostra
+static bool repondo;           // Gravando o histórico pré-disparo
+static uint32_t pos_restantes; // Amostras que faltam na janela pós-disparo
+static uint32_t vista_id;      // Última amostra entregue aos estágios que veem todas (trigger, resumo, espectro, gráfico)
+
+// Resumo por janela: no fluxo principal (so_resumo) ou no auxiliar, escrito pelo core0
+static uint32_t resumo_janela;
+static bool so_resumo;
+static win_stats_t janela;
+static bool resumo_pronto;
+static char linha_resumo[WIN_STATS_REG_MAX];
+static size_t linha_resumo_len;
+static bool espectro_pronto;   // Janela do espectro fechada, bandas ainda não entregues
+static pipe_aux_t aux[PIPE_AUX];
+static volatile uint32_t aux_cabeca, aux_cauda;
+
+// Lê uma amostra para a fila; false quando a captura já acabou
+static bool amostrar(void){
+    if (!amostrando || (max_slots && slots >= max_slots)){
+        amostrando = false;
+        __sev();
+        return false;
+    }
+    uint32_t id = ++slots;
+    uint32_t nivel = fila_cabeca - fila_cauda;
+    if (nivel >= PIPE_FILA){
+        stats.amostras_perdidas++; // core1 não acompanhou: descarta em vez de bloquear a ISR
+        return true;
+    }
+    amostra_t *a = &fila[fila_cabeca & (PIPE_FILA - 1)];
+    if (mpu6050_ler_amostra(a->canais)){
+        calib_aplicar(a->canais); // Todos os estágios seguintes já veem unidades corrigidas
+        a->id = id;
+        __dmb();
+        fila_cabeca++;
+        stats.amostras_lidas++;
+        stats_fila(nivel + 1);
+        __sev();
+    } else {
+        stats.amostras_perdidas++; // Falha no I2C (já contada em erros_i2c): o slot fica sem amostra
+    }
+    return true;
+}
+
+static bool amostrador(repeating_timer_t *rt){
+    return amostrar();
+}
+
+bool pipeline_drdy_irq(void){
+    if (!drdy_ligado) return false;
+    amostrar(); // Um pulso por amostra do sensor: nem leitura repetida nem perdida por deriva
+    return true;
+}
+
+static const char *cabecalho(void){
+    return cabecalho_txt;
+}
+
+void pipeline_iniciar(bool bin, uint32_t sessao, uint32_t periodo_us, uint32_t max_amostras){
+    multicore_fifo_drain();
+    fila_cabeca = fila_cauda = 0;
+    for (int i = 0; i < PIPE_SETORES; i++) livres[i] = (uint8_t)i;
+    livres_cauda = 0;
+    livres_cabeca = PIPE_SETORES;
+    formato_bin = bin;
+    atual = NULL;
+    codec_aberto = false;
+    seq = 0;
+    sessao_atual = sessao;
+    if (so_resumo) formato_bin = false; // Resumos são sempre texto
+    // Cada arquivo abre com os coeficientes em uso: comentário no CSV, bloco de anotação no binário
+    size_t n = calib_registro(cabecalho_txt, sizeof(cabecalho_txt));
+    if (so_resumo)
+        snprintf(cabecalho_txt + n, sizeof(cabecalho_txt) - n, "%s", win_stats_cabecalho);
+    else
+        snprintf(cabecalho_txt + n, sizeof(cabecalho_txt) - n, "%s%s\n", cabecalho_csv, ahrs_cfg.ligado ? ahrs_cabecalho : "");
+    canais = MPU6050_CANAIS + (ahrs_cfg.ligado ? AHRS_CANAIS : 0);
+    ahrs_reiniciar(pipeline_periodo_us(periodo_us)); // O dt do filtro segue a taxa real do DRDY
+    nota_pendente = formato_bin && n;
+    pendente = formato_bin ? NULL : cabecalho(); // O CSV abre com o cabeçalho
+    pendente_len = formato_bin ? 0 : strlen(pendente);
+    seg_bytes = seg_amostras = 0;
+    por_evento = trigger_cfg.modo != TRIGGER_DESLIGADO && !so_resumo;
+    em_evento = fim_evento = repondo = false;
+    vista_id = 0;
+    win_stats_zerar(&janela);
+    resumo_pronto = espectro_pronto = false;
+    espectro_reiniciar();
+    grafico_reiniciar(pipeline_periodo_us(periodo_us)); // 40 ms por coluna na taxa que o DRDY entrega
+    aux_cabeca = aux_cauda = 0;
+    trigger_reiniciar();
+    slots = 0;
+    max_slots = max_amostras;
+    amostrando = true;
+    __dmb();
+    ativo = true;
+    if (relogio == PIPE_RELOGIO_DRDY){
+        uint32_t hz = mpu6050_drdy(1000000u / periodo_us);
+        printf("[INFO] Relógio DRDY do sensor: %lu Hz\n", (unsigned long)hz);
+        drdy_ligado = true;
+        return;
+    }
+    // Atraso negativo: período medido entre inícios de chamada, sem acumular deriva
+    add_repeating_timer_us(-(int64_t)periodo_us, amostrador, NULL, &timer_amostras);
+}
+
+void pipeline_relogio(pipe_relogio_t r){
+    relogio = r;
+}
+
+pipe_relogio_t pipeline_relogio_atual(void){
+    return relogio;
+}
+
+uint32_t pipeline_periodo_us(uint32_t periodo_us){
+    if (relogio != PIPE_RELOGIO_DRDY) return periodo_us;
+    return 1000000u / mpu6050_drdy_hz(1000000u / periodo_us);
+}
+
+void pipeline_resumo(uint32_t n, bool so){
+    resumo_janela = n > WIN_STATS_MAX ? WIN_STATS_MAX : n;
+    so_resumo = so && resumo_janela;
+}
+
+const pipe_aux_t *pipeline_proximo_aux(void){
+    if (aux_cauda == aux_cabeca) return NULL;
+    __dmb();
+    return &aux[aux_cauda & (PIPE_AUX - 1)];
+}
+
+void pipeline_liberar_aux(void){
+    __dmb();
+    aux_cauda++;
+    __sev();
+}
+
+void pipeline_segmentar(uint32_t max_bytes, uint32_t max_amostras){
+    seg_max_bytes = max_bytes;
+    seg_max_amostras = max_amostras;
+}
+
+void pipeline_parar(void){
+    cancel_repeating_timer(&timer_amostras);
+    amostrando = false;
+    __sev();
+    if (drdy_ligado){
+        // A ISR já ignora os pulsos; o sensor para de gerá-los
+        drdy_ligado = false;
+        mpu6050_drdy_desligar();
+    }
+}
+
+void pipeline_interromper(void){
+    amostrando = false; // O timer se cancela no próximo disparo; pulsos DRDY passam a ser ignorados
+    __sev();
+}
+
+bool pipeline_ativo(void){
+    return ativo;
+}
+
+bool pipeline_proximo_setor(uint32_t timeout_us, pipe_setor_t **setor, bool *ultimo){
+    uint32_t v;
+    if (!multicore_fifo_pop_timeout_us(timeout_us, &v)) return false;
+    *setor = &setores[v & ~PIPE_ULTIMO];
+    *ultimo = (v & PIPE_ULTIMO) != 0;
+    return true;
+}
+
+void pipeline_liberar_setor(pipe_setor_t *setor){
+    livres[livres_cabeca & (PIPE_SETORES - 1)] = (uint8_t)(setor - setores);
+    __dmb();
+    livres_cabeca++;
+    __sev();
+}
+
+// Garante um setor em preenchimento; false se todos estão com o core0
+static bool setor_garantir(void){
+    if (atual) return true;
+    if (livres_cauda == livres_cabeca) return false;
+    atual = &setores[livres[livres_cauda & (PIPE_SETORES - 1)]];
+    __dmb();
+    livres_cauda++;
+    pos = 0;
+    codec_aberto = false;
+    return true;
+}
+
+static void setor_emitir(bool ultimo, bool fim_segmento){
+    uint32_t idx = (uint32_t)(atual - setores);
+    atual->len = pos;
+    atual->fim_segmento = fim_segmento;
+    seg_bytes += pos;
+    __dmb();
+    // Nunca bloqueia: há no máximo PIPE_SETORES índices em trânsito
+    multicore_fifo_push_blocking(ultimo ? idx | PIPE_ULTIMO : idx);
+    atual = NULL;
+}
+
+static void codec_fechar(void){
+    imu_codec_finalizar(&codec);
+    pos = IMU_BLOCO_TAM;
+    codec_aberto = false;
+}
+
+// Fecha o arquivo atual entre duas amostras; o próximo começa completo
+static void segmento_cortar(void){
+    if (codec_aberto) codec_fechar();
+    setor_emitir(false, true);
+    seg_bytes = seg_amostras = 0;
+    if (!formato_bin){
+        pendente = cabecalho(); // Cada segmento CSV é um arquivo completo
+        pendente_len = strlen(pendente);
+    } else {
+        nota_pendente = calib_ativa();
+    }
+}
+
+static bool segmento_cheio(void){
+    return (seg_max_bytes && seg_bytes + pos + PIPE_SETOR_TAM > seg_max_bytes) ||
+           (seg_max_amostras && seg_amostras >= seg_max_amostras);
+}
+
+// Fecha a janela atual em um registro de resumo
+static void resumo_fechar(void){
+    linha_resumo_len = win_stats_registro(&janela, linha_resumo);
+    if (so_resumo) seg_amostras += janela.n; // O limite de duração segue contando amostras
+    win_stats_zerar(&janela);
+    resumo_pronto = true;
+}
+
+// Próximo registro livre da fila auxiliar; NULL se o core0 ainda não esvaziou os anteriores
+static pipe_aux_t *aux_novo(pipe_aux_tipo_t tipo){
+    if (aux_cabeca - aux_cauda >= PIPE_AUX) return NULL;
+    pipe_aux_t *r = &aux[aux_cabeca & (PIPE_AUX - 1)];
+    r->tipo = (uint8_t)tipo;
+    return r;
+}
+
+static void aux_publicar(void){
+    __dmb();
+    aux_cabeca++;
+}
+
+// Entrega o resumo pendente; false se a fila auxiliar está cheia
+static bool resumo_entregar(void){
+    if (so_resumo){
+        pendente = linha_resumo;
+        pendente_len = linha_resumo_len;
+    } else {
+        pipe_aux_t *r = aux_novo(PIPE_AUX_RESUMO);
+        if (!r) return false;
+        memcpy(r->txt, linha_resumo, linha_resumo_len);
+        r->len = (uint16_t)linha_resumo_len;
+        aux_publicar();
+    }
+    resumo_pronto = false;
+    return true;
+}
+
+// Registro CSV de uma amostra, canais derivados incluídos; dst precisa de sizeof(linha) bytes
+static size_t csv_registro(char *dst, const amostra_t *a){
+    size_t len = csv_fmt_registro(dst, a->id, &a->canais[0], &a->canais[3], a->canais[6]);
+    if (canais <= MPU6050_CANAIS) return len;
+    char *p = dst + len - 1; // Sobre o '\n'
+    for (uint8_t i = MPU6050_CANAIS; i < canais; i++){
+        *p++ = ',';
+        p = csv_fmt_i32(p, a->canais[i]);
+    }
+    *p++ = '\n';
+    return (size_t)(p - dst);
+}
+
+bool pipeline_core1_passo(void){
+    if (!ativo) return false;
+    bool trabalhou = false;
+    while (setor_garantir()){
+        if (pendente_len){
+            size_t n = PIPE_SETOR_TAM - pos;
+            if (n > pendente_len) n = pendente_len;
+            memcpy(&atual->dados[pos], pendente, n);
+            pos += n;
+            pendente += n;
+            pendente_len -= n;
+            if (pos == PIPE_SETOR_TAM) setor_emitir(false, false);
+            continue;
+        }
+        if (nota_pendente){
+            // Primeiro setor do segmento binário: a linha "# calib" em um bloco sem amostras
+            imu_codec_nota(atual->dados, sessao_atual, seq++, cabecalho_txt, strcspn(cabecalho_txt, "\n") + 1);
+            pos = IMU_BLOCO_TAM;
+            setor_emitir(false, false);
+            nota_pendente = false;
+            continue;
+        }
+        if (resumo_pronto){
+            if (so_resumo && segmento_cheio()){
+                segmento_cortar();
+                continue;
+            }
+            if (!resumo_entregar()) break; // Espera o core0 gravar os anteriores
+            trabalhou = true;
+            continue;
+        }
+        if (espectro_pronto){
+            pipe_aux_t *r = aux_novo(PIPE_AUX_ESPECTRO);
+            if (!r) break;
+            r->len = (uint16_t)espectro_registro(r->txt);
+            aux_publicar();
+            espectro_pronto = false;
+            trabalhou = true;
+            continue;
+        }
+        if (fim_evento){
+            // Um arquivo por evento, e o histórico recomeça do zero
+            fim_evento = false;
+            trigger_limpar_historico();
+            segmento_cortar();
+            continue;
+        }
+        // Origem da próxima amostra: histórico pré-disparo primeiro, depois a fila
+        const amostra_t *a = repondo ? trigger_historico() : NULL;
+        if (repondo && !a) repondo = false;
+        if (!a){
+            if (fila_cauda == fila_cabeca){
+                __dmb();
+                if (amostrando || fila_cauda != fila_cabeca) break;
+                if (janela.n){
+                    resumo_fechar(); // Janela incompleta do fim da captura
+                    continue;
+                }
+                // Amostragem encerrada e fila vazia: fecha o setor parcial e encerra
+                if (codec_aberto) codec_fechar();
+                setor_emitir(true, false);
+                ativo = false;
+                return true;
+            }
+            __dmb();
+            amostra_t *f = &fila[fila_cauda & (PIPE_FILA - 1)];
+            bool nova = f->id != vista_id;
+            vista_id = f->id;
+            if (nova && canais > MPU6050_CANAIS) ahrs_amostra(f->canais); // Antes do histórico copiar a amostra
+            a = f;
+            if (nova){
+                if (resumo_janela){
+                    win_stats_adicionar(&janela, a);
+                    if (janela.n >= resumo_janela) resumo_fechar();
+                }
+                if (espectro_amostra(a)) espectro_pronto = true; // FFT da janela roda aqui, no core1
+                grafico_amostra(a);
+                if (so_resumo){
+                    fila_cauda++; // Sem fluxo bruto: a amostra só alimenta os estágios acima
+                    trabalhou = true;
+                    continue;
+                }
+            }
+            if (por_evento && nova){
+                bool disparou = trigger_amostra(a);
+                if (!em_evento){
+                    fila_cauda++; // Fora de evento a amostra só alimenta o histórico
+                    trabalhou = true;
+                    if (disparou){
+                        em_evento = repondo = true;
+                        pos_restantes = trigger_cfg.pos;
+                    }
+                    continue;
+                }
+                if (disparou) pos_restantes = trigger_cfg.pos; // Novo disparo estende a janela
+            }
+        }
+        // Troca de segmento sempre entre amostras: o setor parcial fecha o arquivo
+        // atual e a amostra seguinte já cai no próximo, sem lacuna
+        if (segmento_cheio()){
+            segmento_cortar();
+            continue;
+        }
+        if (formato_bin){
+            if (codec_aberto && !imu_codec_continua(&codec, a->id)){
+                codec_fechar(); // Amostra descartada no meio do bloco: o próximo recomeça em a->id
+                setor_emitir(false, false);
+                continue;
+            }
+            if (!codec_aberto){
+                imu_codec_iniciar(&codec, atual->dados, canais, sessao_atual, seq++, a->id);
+                codec_aberto = true;
+            }
+            if (!imu_codec_adicionar(&codec, a->canais)){
+                codec_fechar();
+                setor_emitir(false, false);
+                continue; // A amostra fica na origem e abre o próximo bloco
+            }
+        } else if (PIPE_SETOR_TAM - pos >= sizeof(linha)){
+            // Cabe o maior registro possível: formata direto no setor, sem cópia
+            pos += csv_registro((char *)&atual->dados[pos], a);
+            if (pos == PIPE_SETOR_TAM) setor_emitir(false, false);
+        } else {
+            // Perto do fim do setor: o registro passa por 'linha' e é dividido entre dois setores
+            pendente_len = csv_registro(linha, a);
+            pendente = linha;
+        }
+        seg_amostras++;
+        trabalhou = true;
+        if (repondo){
+            trigger_descartar();
+            continue;
+        }
+        fila_cauda++;
+        if (em_evento && --pos_restantes == 0){
+            em_evento = false;
+            fim_evento = true;
+        }
+    }
+    return trabalhou;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/structs/scb.h"
+#include "hardware/sync.h"
+#include "lib/power.h"
+#include "lib/mpu6050.h"
+
+static volatile bool repouso;      // Sensor em ciclo de baixo consumo e OLED apagado
+static uint32_t repouso_s = POWER_REPOUSO_S;
+static uint32_t limiar_mg = POWER_LIMIAR_MG;
+static absolute_time_t ultimo_uso;
+
+void power_iniciar(void){
+    gpio_init(MPU6050_INT_PIN);
+    gpio_set_dir(MPU6050_INT_PIN, GPIO_IN);
+    gpio_pull_down(MPU6050_INT_PIN);
+    // O callback de GPIO já foi registrado pelos botões; aqui só se liga o pino
+    gpio_set_irq_enabled(MPU6050_INT_PIN, GPIO_IRQ_EDGE_RISE, true);
+    // Relógios que continuam ligados quando os dois cores dormem: I2C, SPI, PWM, ADC,
+    // PIO e JTAG param; timer, USB, UART, RTC, GPIO e memórias seguem para poder acordar
+    clocks_hw->sleep_en0 &= ~(CLOCKS_SLEEP_EN0_CLK_SYS_I2C0_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_I2C1_BITS |
+                              CLOCKS_SLEEP_EN0_CLK_PERI_SPI0_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SPI0_BITS |
+                              CLOCKS_SLEEP_EN0_CLK_PERI_SPI1_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_SPI1_BITS |
+                              CLOCKS_SLEEP_EN0_CLK_SYS_PWM_BITS | CLOCKS_SLEEP_EN0_CLK_ADC_ADC_BITS |
+                              CLOCKS_SLEEP_EN0_CLK_SYS_ADC_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_PIO0_BITS |
+                              CLOCKS_SLEEP_EN0_CLK_SYS_PIO1_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_JTAG_BITS);
+    ultimo_uso = get_absolute_time();
+}
+
+void power_config(uint32_t s, uint32_t mg){
+    repouso_s = s;
+    limiar_mg = mg;
+    power_atividade();
+}
+
+void power_imprimir(void){
+    if (repouso_s)
+        printf("Repouso após %lu s sem uso; acorda com variação de %lu mg\n",
+               (unsigned long)repouso_s, (unsigned long)limiar_mg);
+    else
+        printf("Repouso desligado\n");
+}
+
+void power_atividade(void){
+    ultimo_uso = get_absolute_time();
+    if (repouso){
+        mpu6050_normal();
+        repouso = false;
+        __sev(); // core1 reacende o OLED
+    }
+}
+
+uint32_t power_verificar(void){
+    if (!repouso_s || repouso) return 0;
+    int64_t resta = (int64_t)repouso_s * 1000000 - absolute_time_diff_us(ultimo_uso, get_absolute_time());
+    if (resta > 0) return (uint32_t)((resta + 999) / 1000);
+    printf("\n[INFO] Repouso: movimento, botão ou serial acordam.\n");
+    stdio_flush();
+    mpu6050_movimento(limiar_mg, 1);
+    repouso = true;
+    __sev(); // core1 apaga o OLED
+    return 0;
+}
+
+void power_dormir(void){
+    // Com SLEEPDEEP, quando os dois cores dormem o sistema corta os relógios fora do SLEEP_EN
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    __wfe();
+    scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+}
+
+bool power_tela_ligada(void){
+    return !repouso;
+}
@@ -1,5 +1,6 @@
 #include "lib/ssd1306.h"
 #include "lib/font.h"
+#include <string.h>
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -11,6 +12,11 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->shadow = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->tx_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  memset(ssd->dirty, 0, sizeof(ssd->dirty));
+  ssd->synced = false; // A RAM do painel liga com lixo
+  ssd->scrolling = false;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -52,13 +58,17 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
+static void ssd1306_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
   ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
+  ssd1306_command(ssd, x0);
+  ssd1306_command(ssd, x1);
   ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
+  ssd1306_command(ssd, p0);
+  ssd1306_command(ssd, p1);
+}
+
+void ssd1306_send_data(ssd1306_t *ssd) {
+  ssd1306_window(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
   i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
@@ -66,35 +76,157 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     ssd->bufsize,
     false
   );
+  memcpy(ssd->shadow, ssd->ram_buffer, ssd->bufsize);
+  memset(ssd->dirty, 0, sizeof(ssd->dirty));
+  ssd->synced = true;
+}
+
+// Páginas da coluna x que mudaram de fato desde o último envio; limpa as marcas
+static uint8_t ssd1306_column_changes(ssd1306_t *ssd, uint8_t x) {
+  uint8_t mask = 0;
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    uint8_t *d = &ssd->dirty[p][x >> 3];
+    if (!(*d & (1 << (x & 7)))) continue;
+    *d &= ~(1 << (x & 7));
+    uint16_t index = p + (x << 3) + 1;
+    if (ssd->ram_buffer[index] != ssd->shadow[index]) mask |= 1 << p;
+  }
+  return mask;
+}
+
+// Endereçamento vertical: a janela chega coluna a coluna, páginas p0..p1 em cada uma
+size_t ssd1306_send_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  size_t n = 1;
+  ssd->tx_buffer[0] = 0x40;
+  for (uint8_t x = x0; x <= x1; ++x) {
+    uint16_t index = p0 + (x << 3) + 1;
+    uint8_t len = p1 - p0 + 1;
+    memcpy(&ssd->tx_buffer[n], &ssd->ram_buffer[index], len);
+    memcpy(&ssd->shadow[index], &ssd->ram_buffer[index], len);
+    n += len;
+  }
+  ssd1306_window(ssd, x0, x1, p0, p1);
+  i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->tx_buffer, n, false);
+  return n - 1;
+}
+
+size_t ssd1306_flush_dirty(ssd1306_t *ssd) {
+  if (!ssd->synced) {
+    ssd1306_send_data(ssd);
+    return ssd->bufsize - 1;
+  }
+  size_t sent = 0;
+  int start = -1, last = -1;
+  uint8_t pages = 0;
+  for (int x = 0; x <= ssd->width; ++x) {
+    uint8_t mask = x < ssd->width ? ssd1306_column_changes(ssd, x) : 0;
+    if (mask) {
+      // Colunas limpas no meio de uma corrida custam menos que abrir outra janela
+      if (start >= 0 && x - last > SSD1306_MERGE_GAP) {
+        sent += ssd1306_send_window(ssd, start, last, __builtin_ctz(pages), 31 - __builtin_clz(pages));
+        start = -1;
+      }
+      if (start < 0) {
+        start = x;
+        pages = 0;
+      }
+      pages |= mask;
+      last = x;
+    }
+  }
+  if (start >= 0)
+    sent += ssd1306_send_window(ssd, start, last, __builtin_ctz(pages), 31 - __builtin_clz(pages));
+  return sent;
+}
+
+// Gira uma coluna para a esquerda as páginas p0..p1 entre x0 e x1
+static void ssd1306_rotate_left(uint8_t *buf, uint8_t p0, uint8_t p1, uint8_t x0, uint8_t x1) {
+  uint8_t first[8];
+  uint8_t len = p1 - p0 + 1;
+  memcpy(first, &buf[p0 + (x0 << 3) + 1], len);
+  for (uint8_t x = x0; x < x1; ++x)
+    memcpy(&buf[p0 + (x << 3) + 1], &buf[p0 + ((x + 1) << 3) + 1], len);
+  memcpy(&buf[p0 + (x1 << 3) + 1], first, len);
+}
+
+// Com 'hardware' o painel desloca a própria RAM pelo comando de rolagem de uma
+// coluna (0x2D) e nada passa pelo I2C; o modelo local acompanha a rolagem. Sem
+// ele, só o buffer é deslocado e o próximo flush reenvia a região inteira.
+// O controlador pede pelo menos dois quadros (~20 ms) entre rolagens.
+void ssd1306_scroll_left(ssd1306_t *ssd, uint8_t p0, uint8_t p1, uint8_t x0, uint8_t x1, bool hardware) {
+  ssd1306_rotate_left(ssd->ram_buffer, p0, p1, x0, x1);
+  if (hardware && ssd->synced) {
+    ssd1306_command(ssd, SET_SCROLL_COL_LEFT);
+    ssd1306_command(ssd, 0x00);
+    ssd1306_command(ssd, p0);
+    ssd1306_command(ssd, 0x01);
+    ssd1306_command(ssd, p1);
+    ssd1306_command(ssd, 0x00);
+    ssd1306_command(ssd, x0);
+    ssd1306_command(ssd, x1);
+    ssd1306_rotate_left(ssd->shadow, p0, p1, x0, x1);
+    return;
+  }
+  for (uint8_t p = p0; p <= p1; ++p)
+    for (uint8_t x = x0; x <= x1; ++x)
+      ssd->dirty[p][x >> 3] |= 1 << (x & 7);
+}
+
+// Rolagem contínua de página inteira, presente em todo SSD1306: o painel desloca a
+// própria RAM uma coluna a cada 3 quadros (SSD1306_SCROLL_FRAMES_CODE), contados a partir
+// do 0x2F. Enquanto ela corre a RAM não pode ser escrita; o chamador para a rolagem
+// depois de um passo e antes do segundo, e o modelo local acompanha esse passo.
+void ssd1306_scroll_start(ssd1306_t *ssd, uint8_t p0, uint8_t p1) {
+  if (ssd->scrolling) return;
+  ssd1306_command(ssd, SET_SCROLL_LEFT);
+  ssd1306_command(ssd, 0x00);
+  ssd1306_command(ssd, p0);
+  ssd1306_command(ssd, SSD1306_SCROLL_FRAMES_CODE);
+  ssd1306_command(ssd, p1);
+  ssd1306_command(ssd, 0x00);
+  ssd1306_command(ssd, 0xFF);
+  ssd1306_command(ssd, SET_SCROLL_ON);
+  ssd->scrolling = true;
+  ssd->scroll_p0 = p0;
+  ssd->scroll_p1 = p1;
+}
+
+// Fora da janela de um passo o deslocamento do painel é incerto: a área rolada é
+// reenviada a partir do buffer
+void ssd1306_scroll_stop(ssd1306_t *ssd, uint32_t elapsed_ms) {
+  if (!ssd->scrolling) return;
+  ssd1306_command(ssd, SET_SCROLL_OFF);
+  ssd->scrolling = false;
+  uint8_t x1 = ssd->width - 1;
+  ssd1306_rotate_left(ssd->ram_buffer, ssd->scroll_p0, ssd->scroll_p1, 0, x1);
+  ssd1306_rotate_left(ssd->shadow, ssd->scroll_p0, ssd->scroll_p1, 0, x1);
+  if (elapsed_ms < SSD1306_SCROLL_STEP_MAX_MS || elapsed_ms >= 2 * SSD1306_SCROLL_STEP_MIN_MS)
+    ssd1306_send_window(ssd, 0, x1, ssd->scroll_p0, ssd->scroll_p1);
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height) return;
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
+  uint8_t old = ssd->ram_buffer[index];
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
+  if (ssd->ram_buffer[index] != old)
+    ssd->dirty[y >> 3][x >> 3] |= 1 << (x & 7);
 }
 
-/*
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
   uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
+  for (size_t i = 1; i < ssd->bufsize; ++i) {
+    if (ssd->ram_buffer[i] == byte) continue;
     ssd->ram_buffer[i] = byte;
-}*/
-
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+    uint8_t x = (i - 1) >> 3;
+    ssd->dirty[(i - 1) & 7][x >> 3] |= 1 << (x & 7);
+  }
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
   for (uint8_t x = left; x < left + width; ++x) {
     ssd1306_pixel(ssd, x, top, value);
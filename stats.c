@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "lib/stats.h"
+#include "hw_config.h"
+#include "sd_card.h"
+
+stats_t stats;
+
+// Acumuladores da janela de carga, um por core (cada core só mexe no seu)
+static uint32_t janela_inicio[2];
+static uint32_t janela_ocupado[2];
+
+void stats_reset(void){
+    stats.amostras_lidas = 0;
+    stats.amostras_perdidas = 0;
+    stats.fila_max = 0;
+    stats.bytes_gravados = 0;
+    stats.erros_i2c = 0;
+    for (int i = 0; i < STATS_FAIXAS; i++){
+        stats.hist_write[i] = 0;
+        stats.hist_sync[i] = 0;
+    }
+    for (size_t i = 0; i < sd_get_num(); ++i)
+        sd_get_by_num(i)->cmd_retries = 0;
+}
+
+void stats_latencia(volatile uint32_t hist[STATS_FAIXAS], uint32_t us){
+    // Faixa i guarda latências em [2^(i-1), 2^i) us; a última acumula o restante
+    uint32_t faixa = us ? 32 - __builtin_clz(us) : 0;
+    if (faixa >= STATS_FAIXAS) faixa = STATS_FAIXAS - 1;
+    hist[faixa]++;
+}
+
+void stats_fila(uint32_t nivel){
+    if (nivel > stats.fila_max) stats.fila_max = nivel;
+}
+
+void stats_ocupado(uint32_t us){
+    uint core = get_core_num();
+    uint32_t agora = time_us_32();
+    janela_ocupado[core] += us;
+    uint32_t decorrido = agora - janela_inicio[core];
+    if (decorrido >= STATS_JANELA_US){
+        uint32_t carga = (uint32_t)(((uint64_t)janela_ocupado[core] * 1000) / decorrido);
+        stats.carga_pm[core] = carga > 1000 ? 1000 : carga;
+        janela_ocupado[core] = 0;
+        janela_inicio[core] = agora;
+    }
+}
+
+uint64_t stats_bytes_gravados(void){
+    // Escrito pelo core0 em duas metades: relê até obter duas leituras iguais
+    uint64_t a, b = stats.bytes_gravados;
+    do { a = b; b = stats.bytes_gravados; } while (a != b);
+    return a;
+}
+
+uint32_t stats_retries_sd(void){
+    uint32_t total = 0;
+    for (size_t i = 0; i < sd_get_num(); ++i)
+        total += sd_get_by_num(i)->cmd_retries;
+    return total;
+}
+
+static void imprimir_histograma(const char *nome, volatile uint32_t hist[STATS_FAIXAS]){
+    printf("Latência %s:\n", nome);
+    for (int i = 0; i < STATS_FAIXAS; i++){
+        if (!hist[i]) continue;
+        if (i == STATS_FAIXAS - 1)
+            printf("  >= %6lu us: %lu\n", 1UL << (i - 1), (unsigned long)hist[i]);
+        else
+            printf("  <  %6lu us: %lu\n", 1UL << i, (unsigned long)hist[i]);
+    }
+}
+
+void stats_imprimir(void){
+    printf("\nEstatísticas da captura:\n");
+    printf("Amostras lidas:    %lu\n", (unsigned long)stats.amostras_lidas);
+    printf("Amostras perdidas: %lu\n", (unsigned long)stats.amostras_perdidas);
+    printf("Pico da fila:      %lu\n", (unsigned long)stats.fila_max);
+    printf("Bytes gravados:    %llu\n", (unsigned long long)stats_bytes_gravados());
+    printf("Erros I2C:         %lu\n", (unsigned long)stats.erros_i2c);
+    printf("Retries SD:        %lu\n", (unsigned long)stats_retries_sd());
+    printf("Carga core0/core1: %lu.%lu%% / %lu.%lu%%\n",
+           (unsigned long)stats.carga_pm[0] / 10, (unsigned long)stats.carga_pm[0] % 10,
+           (unsigned long)stats.carga_pm[1] / 10, (unsigned long)stats.carga_pm[1] % 10);
+    imprimir_histograma("f_write", stats.hist_write);
+    imprimir_histograma("f_sync", stats.hist_sync);
+}
+
+void stats_publicar(void){
+    ui_telemetria_t t = {
+        .amostras_lidas = stats.amostras_lidas,
+        .amostras_perdidas = stats.amostras_perdidas,
+        .bytes_gravados = stats_bytes_gravados(),
+        .erros_i2c = stats.erros_i2c,
+        .retries_sd = stats_retries_sd(),
+        .carga_pm = {stats.carga_pm[0], stats.carga_pm[1]},
+    };
+    ui_telemetria(&t);
+}
+
+void stats_desenhar(ssd1306_t *ssd, const ui_telemetria_t *t){
+    char linha[16];
+    ssd1306_fill(ssd, false);
+    ssd1306_draw_string(ssd, "Captura", 0, 0);
+    snprintf(linha, sizeof(linha), "N %lu", (unsigned long)t->amostras_lidas);
+    ssd1306_draw_string(ssd, linha, 0, 8);
+    snprintf(linha, sizeof(linha), "Perd %lu", (unsigned long)t->amostras_perdidas);
+    ssd1306_draw_string(ssd, linha, 0, 16);
+    snprintf(linha, sizeof(linha), "KB %lu", (unsigned long)(t->bytes_gravados / 1024));
+    ssd1306_draw_string(ssd, linha, 0, 24);
+    snprintf(linha, sizeof(linha), "I2C %lu SD %lu", (unsigned long)t->erros_i2c, (unsigned long)t->retries_sd);
+    ssd1306_draw_string(ssd, linha, 0, 32);
+    snprintf(linha, sizeof(linha), "C0 %lu%% C1 %lu%%", (unsigned long)t->carga_pm[0] / 10,
+             (unsigned long)t->carga_pm[1] / 10);
+    ssd1306_draw_string(ssd, linha, 0, 40);
+}
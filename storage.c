@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "lib/storage.h"
+#include "lib/pipeline.h"
+#include "lib/stats.h"
+#include "f_util.h"
+#include "sd_card.h"
+
+// Fila SPSC: o core0 escreve os pedidos e avança 'cabeca'; o core1 os executa e
+// avança 'feitos'; o core0 chama os callbacks e avança 'entregues'. Uma posição
+// só volta a ser usada depois do callback, então o resultado continua válido até lá.
+static storage_pedido_t fila[STORAGE_FILA];
+static volatile uint32_t cabeca, feitos;
+static uint32_t entregues;
+
+// Estado do pedido longo em andamento, exclusivo do core1
+static bool em_curso;
+static DIR dir;
+static FILINFO fno;
+static FIL arq;
+static char linha[STORAGE_LINHA_MAX];
+
+// Gancho do driver do SD: roda enquanto o cartão segura a linha de dados
+static void cartao_ocupado(void){
+    if (get_core_num() == 1) pipeline_core1_passo(); // Nunca toca no cartão
+}
+
+void storage_iniciar(void){
+    sd_set_busy_hook(cartao_ocupado);
+}
+
+static bool listar(storage_pedido_t *p){
+    if (!em_curso){
+        static char cwd[FF_LFN_BUF + 1];
+        const char *d = p->nome;
+        if (!d[0]){
+            p->res = f_getcwd(cwd, sizeof cwd);
+            if (FR_OK != p->res){
+                printf("f_getcwd error: %s (%d)\n", FRESULT_str(p->res), p->res);
+                return true;
+            }
+            d = cwd;
+        }
+        printf("Directory Listing: %s\n", d);
+        memset(&dir, 0, sizeof dir);
+        p->res = f_findfirst(&dir, &fno, d, "*");
+        if (FR_OK != p->res){
+            printf("f_findfirst error: %s (%d)\n", FRESULT_str(p->res), p->res);
+            return true;
+        }
+        em_curso = true;
+    }
+    // Uma entrada por passo
+    if (FR_OK == p->res && fno.fname[0]){
+        const char *atrib = fno.fattrib & AM_DIR ? "directory"
+                          : fno.fattrib & AM_RDO ? "read only file" : "writable file";
+        printf("%s [%s] [size=%llu]\n", fno.fname, atrib, (unsigned long long)fno.fsize);
+        p->n++;
+        p->res = f_findnext(&dir, &fno);
+        return false;
+    }
+    f_closedir(&dir);
+    em_curso = false;
+    return true;
+}
+
+static bool mostrar(storage_pedido_t *p){
+    if (!em_curso){
+        p->res = f_open(&arq, p->nome, FA_READ);
+        if (FR_OK != p->res){
+            printf("f_open error: %s (%d)\n", FRESULT_str(p->res), p->res);
+            return true;
+        }
+        em_curso = true;
+    }
+    // Uma linha por passo
+    if (f_gets(linha, sizeof linha, &arq)){
+        printf("%s", linha);
+        p->n += strlen(linha);
+        return false;
+    }
+    p->res = f_close(&arq);
+    em_curso = false;
+    return true;
+}
+
+static void ler(storage_pedido_t *p){
+    FIL f;
+    UINT br = 0;
+    p->res = f_open(&f, p->nome, FA_READ);
+    if (FR_OK != p->res) return;
+    p->res = f_lseek(&f, p->pos);
+    if (FR_OK == p->res) p->res = f_read(&f, p->dados, p->len, &br);
+    p->n = br;
+    f_close(&f);
+}
+
+static void espaco(storage_pedido_t *p){
+    DWORD livres;
+    FATFS *fs;
+    p->res = f_getfree(p->nome, &livres, &fs);
+    if (FR_OK != p->res) return;
+    p->n = livres * fs->csize / 2;
+    p->total = (fs->n_fatent - 2) * fs->csize / 2;
+}
+
+// true quando o pedido terminou
+static bool executar(storage_pedido_t *p){
+    UINT bw = 0;
+    switch (p->op){
+        case STORAGE_ANEXAR: {
+            uint32_t t0 = time_us_32();
+            p->res = f_write(p->fil, p->dados, p->len, &bw);
+            stats_latencia(stats.hist_write, time_us_32() - t0);
+            p->n = bw;
+            return true;
+        }
+        case STORAGE_ABRIR:
+            p->res = f_open(p->fil, p->nome, (BYTE)p->len);
+            return true;
+        case STORAGE_FECHAR:
+            p->res = f_close(p->fil);
+            return true;
+        case STORAGE_SINCRONIZAR:
+            p->res = f_sync(p->fil);
+            return true;
+        case STORAGE_LER:
+            ler(p);
+            return true;
+        case STORAGE_LISTAR:
+            return listar(p);
+        case STORAGE_MOSTRAR:
+            return mostrar(p);
+        case STORAGE_ESPACO:
+            espaco(p);
+            return true;
+        case STORAGE_CHAMAR:
+            p->res = p->fn(p);
+            return true;
+        default:
+            p->res = FR_INVALID_PARAMETER;
+            return true;
+    }
+}
+
+bool storage_passo(void){
+    if (feitos == cabeca) return false;
+    storage_pedido_t *p = &fila[feitos & (STORAGE_FILA - 1)];
+    __dmb();
+    if (!executar(p)) return true; // Pedido longo: continua no próximo passo
+    __dmb();
+    feitos++;
+    __sev(); // Acorda o core0 para o callback
+    return true;
+}
+
+void storage_enviar(const storage_pedido_t *p){
+    while (cabeca - entregues >= STORAGE_FILA){
+        storage_concluir();
+        if (cabeca - entregues >= STORAGE_FILA) __wfe();
+    }
+    storage_pedido_t *d = &fila[cabeca & (STORAGE_FILA - 1)];
+    *d = *p;
+    d->res = FR_OK;
+    d->n = d->total = 0;
+    __dmb();
+    cabeca++;
+    __sev(); // O core1 pode estar dormindo no laço do display
+}
+
+void storage_anexar(FIL *fil, const void *dados, uint32_t len, storage_cb_t cb, void *ctx){
+    storage_pedido_t p = {.op = STORAGE_ANEXAR, .fil = fil, .dados = (void *)dados, .len = len, .cb = cb, .ctx = ctx};
+    storage_enviar(&p);
+}
+
+static FRESULT chamada_res;
+
+static void chamada_fim(const storage_pedido_t *p){
+    chamada_res = p->res;
+}
+
+FRESULT storage_chamar(storage_fn_t fn, void *ctx){
+    storage_pedido_t p = {.op = STORAGE_CHAMAR, .fn = fn, .ctx = ctx, .cb = chamada_fim};
+    storage_enviar(&p);
+    uint32_t alvo = cabeca; // Entregue quando 'entregues' alcançar este valor
+    while ((int32_t)(entregues - alvo) < 0){
+        storage_concluir();
+        if ((int32_t)(entregues - alvo) < 0) __wfe();
+    }
+    return chamada_res;
+}
+
+void storage_concluir(void){
+    while (entregues != feitos){
+        __dmb();
+        // Cópia: o callback pode enfileirar novos pedidos, inclusive nesta posição
+        storage_pedido_t p = fila[entregues & (STORAGE_FILA - 1)];
+        entregues++;
+        if (p.cb) p.cb(&p);
+    }
+}
+
+void storage_esperar(void){
+    while (true){
+        storage_concluir();
+        if (entregues == cabeca) return;
+        __wfe();
+    }
+}
+
+uint32_t storage_pendentes(void){
+    return cabeca - entregues;
+}
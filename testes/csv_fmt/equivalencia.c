@@ -0,0 +1,98 @@
+// Equivalência e tempo do formatador CSV no host: csv_fmt.c contra o sprintf com
+// float que ele substituiu. Compara todas as 65536 leituras de temperatura, todos
+// os valores de canal com e sem sinal, ids nas bordas de cada número de dígitos e
+// linhas aleatórias, e depois mede as duas implementações.
+//
+//   gcc -O2 -I../.. equivalencia.c ../../csv_fmt.c -o equivalencia
+//   ./equivalencia
+//
+// Sai com 0 quando não há nenhuma divergência.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "lib/csv_fmt.h"
+
+#define LINHAS_ALEATORIAS 1000000
+#define LINHAS_TEMPO 2000000
+
+static uint32_t semente = 12345;
+static int16_t aleatorio16(void){
+    semente = semente * 1664525u + 1013904223u;
+    return (int16_t)(semente >> 16);
+}
+
+static uint64_t agora_ns(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static unsigned long erros;
+
+static void compara(uint32_t id, const int16_t accel[3], const int16_t gyro[3], int16_t temp){
+    char ref[80], nova[CSV_REG_MAX];
+    float temperature = (temp / 340.0f) + 36.53f;
+    int len_ref = sprintf(ref, "%lu,%d,%d,%d,%d,%d,%d,%.1f\n", (unsigned long)id,
+                          accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temperature);
+    size_t len = csv_fmt_registro(nova, id, accel, gyro, temp);
+    if ((size_t)len_ref == len && 0 == memcmp(ref, nova, len)) return;
+    if (erros++ < 10) printf("Divergência: \"%.*s\" != \"%.*s\"\n", len_ref - 1, ref, (int)len - 1, nova);
+}
+
+// Canais derivados (AHRS) saem por csv_fmt_i32 fora do registro
+static void compara_i32(int32_t v){
+    char ref[16], nova[16];
+    int len_ref = sprintf(ref, "%ld", (long)v);
+    size_t len = (size_t)(csv_fmt_i32(nova, v) - nova);
+    if ((size_t)len_ref == len && 0 == memcmp(ref, nova, len)) return;
+    if (erros++ < 10) printf("Divergência: \"%s\" != \"%.*s\"\n", ref, (int)len, nova);
+}
+
+int main(void){
+    int16_t accel[3] = {0, 0, 0}, gyro[3] = {0, 0, 0};
+
+    for (int32_t t = INT16_MIN; t <= INT16_MAX; t++)
+        compara(1, accel, gyro, (int16_t)t);
+    for (int32_t v = INT16_MIN; v <= INT16_MAX; v++){
+        accel[0] = accel[1] = accel[2] = (int16_t)v;
+        gyro[0] = gyro[1] = gyro[2] = (int16_t)-v;
+        compara((uint32_t)(v - INT16_MIN), accel, gyro, (int16_t)v);
+    }
+    // Ids de 1 a 10 dígitos, nas duas bordas de cada potência de 10
+    for (uint64_t p = 1; p <= 10000000000ull; p *= 10){
+        compara((uint32_t)(p - 1), accel, gyro, 0);
+        if (p <= UINT32_MAX) compara((uint32_t)p, accel, gyro, 0);
+    }
+    compara(UINT32_MAX, accel, gyro, 0);
+    for (int64_t v = INT32_MIN; v <= INT32_MAX; v += 65537)
+        compara_i32((int32_t)v);
+    compara_i32(INT32_MIN);
+    compara_i32(INT32_MAX);
+    for (uint32_t i = 0; i < LINHAS_ALEATORIAS; i++){
+        for (int c = 0; c < 3; c++){
+            accel[c] = aleatorio16();
+            gyro[c] = aleatorio16();
+        }
+        compara(semente, accel, gyro, aleatorio16());
+    }
+    printf("Divergências: %lu\n", erros);
+
+    // Tempo por linha nas duas implementações; 'total' impede que o laço seja descartado
+    char buf[80];
+    volatile size_t total = 0;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < LINHAS_TEMPO; i++){
+        int16_t t = aleatorio16();
+        float temperature = (t / 340.0f) + 36.53f;
+        total += sprintf(buf, "%lu,%d,%d,%d,%d,%d,%d,%.1f\n", (unsigned long)i,
+                         accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2], temperature);
+    }
+    uint64_t t_sprintf = agora_ns() - t0;
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < LINHAS_TEMPO; i++)
+        total += csv_fmt_registro(buf, i, accel, gyro, aleatorio16());
+    uint64_t t_fmt = agora_ns() - t0;
+    printf("sprintf: %lu ns/linha\ncsv_fmt: %lu ns/linha\n",
+           (unsigned long)(t_sprintf / LINHAS_TEMPO), (unsigned long)(t_fmt / LINHAS_TEMPO));
+    return erros != 0;
+}
@@ -0,0 +1,63 @@
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include "ff.h"
+#include "diskio.h"
+
+// Disco em RAM de 32 MiB. Cada acesso cede a CPU para intercalar as threads
+// dentro do FatFs. O TRIM de uma faixa longa segura o volume como o CMD38 de um
+// cartão lento; faixas curtas (temporários de um cluster) passam direto.
+#define SETORES 65536
+#define TRIM_ATRASO_MS 2000
+#define TRIM_LONGO 32 // Setores a partir dos quais o TRIM demora
+
+static BYTE disco[SETORES][FF_MIN_SS];
+volatile int trims;
+
+DSTATUS disk_status(BYTE pdrv){
+    return 0;
+}
+
+DSTATUS disk_initialize(BYTE pdrv){
+    return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t setor, UINT n){
+    memcpy(buff, disco[setor], n * FF_MIN_SS);
+    sched_yield();
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t setor, UINT n){
+    memcpy(disco[setor], buff, n * FF_MIN_SS);
+    sched_yield();
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff){
+    switch (cmd){
+        case GET_SECTOR_COUNT:
+            *(LBA_t *)buff = SETORES;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = FF_MIN_SS;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD *)buff = 1;
+            return RES_OK;
+        case CTRL_TRIM: {
+            const LBA_t *faixa = buff;
+            if (faixa[1] - faixa[0] + 1 < TRIM_LONGO) return RES_OK;
+            struct timespec t = {TRIM_ATRASO_MS / 1000, (TRIM_ATRASO_MS % 1000) * 1000000L};
+            nanosleep(&t, NULL);
+            trims++;
+            return RES_OK;
+        }
+        default:
+            return RES_OK;
+    }
+}
+
+DWORD get_fattime(void){
+    return 0x58210000;
+}
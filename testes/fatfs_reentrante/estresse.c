@@ -0,0 +1,127 @@
+// Teste de estresse da reentrância do FatFs no host: ff.c, o port OS_TYPE 5 do
+// ffsystem.c (mutex_t emulado com pthreads) e um disco em RAM. Uma thread grava
+// e sincroniza um CSV enquanto a outra lista o diretório, relê um arquivo fixo,
+// consulta o espaço livre e cria e apaga temporários. A gravadora também trunca
+// um arquivo de tempos em tempos; o TRIM do disco segura o volume por 2 s, como
+// o CMD38 no cartão, e a outra thread não pode receber FR_TIMEOUT por isso.
+//
+//   F=../../lib/FatFs_SPI/ff15/source
+//   gcc -O2 -I. -I$F estresse.c disco_ram.c $F/ff.c $F/ffsystem.c $F/ffunicode.c -lpthread -o estresse
+//   ./estresse
+//
+// Sai com 0 quando todas as linhas voltam intactas e nenhuma chamada falhou.
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "ff.h"
+
+#define LINHAS 20000
+#define TRUNCAMENTOS 3 // Um a cada LINHAS / TRUNCAMENTOS linhas
+
+extern volatile int trims;
+static FATFS fs;
+static volatile int fim, erros;
+
+static void falha(const char *onde, FRESULT fr){
+    printf("%s: %d\n", onde, fr);
+    erros++;
+}
+
+static void *gravadora(void *arg){
+    FIL f, t;
+    UINT bw;
+    char l[64];
+    FRESULT fr = f_open(&f, "log.csv", FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr){
+        falha("f_open log", fr);
+        fim = 1;
+        return NULL;
+    }
+    for (int i = 0; i < LINHAS; i++){
+        int n = snprintf(l, sizeof l, "%d,%d,%d\n", i, i * 7, -i);
+        if ((fr = f_write(&f, l, (UINT)n, &bw)) || bw != (UINT)n) falha("f_write", fr);
+        if (i % 500 == 0 && (fr = f_sync(&f))) falha("f_sync", fr);
+        if (i % (LINHAS / TRUNCAMENTOS) == LINHAS / TRUNCAMENTOS / 2){
+            // Arquivo de alguns clusters truncado a zero: libera a cadeia e manda TRIM
+            static BYTE lixo[16384];
+            if ((fr = f_open(&t, "trim.tmp", FA_WRITE | FA_CREATE_ALWAYS)) || (fr = f_write(&t, lixo, sizeof lixo, &bw)) ||
+                (fr = f_sync(&t)) || (fr = f_lseek(&t, 0)) || (fr = f_truncate(&t)) || (fr = f_close(&t)))
+                falha("truncamento", fr);
+        }
+    }
+    if ((fr = f_close(&f))) falha("f_close log", fr);
+    fim = 1;
+    return NULL;
+}
+
+static void *leitora(void *arg){
+    int voltas = 0;
+    while (!fim){
+        DIR d;
+        FILINFO fi;
+        FIL f;
+        UINT br;
+        BYTE b[300];
+        DWORD livres;
+        FATFS *p;
+        FRESULT fr;
+        if ((fr = f_opendir(&d, "/"))) falha("f_opendir", fr);
+        else {
+            while ((fr = f_readdir(&d, &fi)) == FR_OK && fi.fname[0]);
+            if (fr) falha("f_readdir", fr);
+            f_closedir(&d);
+        }
+        if ((fr = f_open(&f, "fixo.txt", FA_READ))) falha("f_open fixo", fr);
+        else {
+            if ((fr = f_read(&f, b, sizeof b, &br)) || br != 256) falha("f_read fixo", fr);
+            for (int i = 0; i < 256; i++)
+                if (b[i] != i) erros++;
+            f_close(&f);
+        }
+        if ((fr = f_getfree("", &livres, &p))) falha("f_getfree", fr);
+        // Temporários disputam a FAT com a gravadora
+        char nome[16];
+        snprintf(nome, sizeof nome, "t%d.tmp", voltas % 4);
+        if ((fr = f_open(&f, nome, FA_WRITE | FA_CREATE_ALWAYS)) || (fr = f_write(&f, b, 256, &br)) ||
+            (fr = f_close(&f)) || (fr = f_unlink(nome)))
+            falha("temporário", fr);
+        voltas++;
+    }
+    printf("leitora: %d voltas\n", voltas);
+    return NULL;
+}
+
+int main(void){
+    static BYTE trabalho[4096];
+    MKFS_PARM opt = {FM_ANY, 0, 0, 0, 0};
+    if (f_mkfs("", &opt, trabalho, sizeof trabalho) || f_mount(&fs, "", 1)){
+        puts("f_mkfs/f_mount falhou");
+        return 1;
+    }
+    FIL f;
+    UINT bw;
+    BYTE b[256];
+    for (int i = 0; i < 256; i++) b[i] = (BYTE)i;
+    f_open(&f, "fixo.txt", FA_WRITE | FA_CREATE_ALWAYS);
+    f_write(&f, b, sizeof b, &bw);
+    f_close(&f);
+
+    pthread_t g, l;
+    pthread_create(&g, NULL, gravadora, NULL);
+    pthread_create(&l, NULL, leitora, NULL);
+    pthread_join(g, NULL);
+    pthread_join(l, NULL);
+
+    // Confere o log inteiro
+    char linha[64], esperada[64];
+    int i = 0;
+    f_open(&f, "log.csv", FA_READ);
+    while (f_gets(linha, sizeof linha, &f)){
+        snprintf(esperada, sizeof esperada, "%d,%d,%d\n", i, i * 7, -i);
+        if (strcmp(linha, esperada)) erros++;
+        i++;
+    }
+    f_close(&f);
+    printf("linhas %d/%d, TRIMs %d, erros %d\n", i, LINHAS, trims, erros);
+    return erros || i != LINHAS || trims < TRUNCAMENTOS;
+}
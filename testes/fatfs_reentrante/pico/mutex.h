@@ -0,0 +1,37 @@
+#pragma once
+
+// pico/mutex.h sobre pthreads: só o que o port OS_TYPE 5 do ffsystem.c usa
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct {
+    pthread_mutex_t m;
+    bool iniciado;
+} mutex_t;
+
+static inline bool mutex_is_initialized(mutex_t *m){
+    return m->iniciado;
+}
+
+static inline void mutex_init(mutex_t *m){
+    pthread_mutex_init(&m->m, NULL);
+    m->iniciado = true;
+}
+
+static inline bool mutex_enter_timeout_ms(mutex_t *m, uint32_t ms){
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    t.tv_sec += ms / 1000;
+    t.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (t.tv_nsec >= 1000000000L){
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000L;
+    }
+    return pthread_mutex_timedlock(&m->m, &t) == 0;
+}
+
+static inline void mutex_exit(mutex_t *m){
+    pthread_mutex_unlock(&m->m);
+}
@@ -0,0 +1,83 @@
+#include "lib/trigger.h"
+
+trigger_cfg_t trigger_cfg = {
+    .modo = TRIGGER_DESLIGADO,
+    .limiar_mg = 300,
+    .razao_x10 = 30,
+    .pre = 256,
+    .pos = 512};
+
+// Histórico e detector pertencem ao core1 durante a captura
+static amostra_t historico[TRIGGER_PRE_MAX];
+static uint32_t hist_cabeca, hist_cauda;
+
+static uint32_t limiar_alto, limiar_baixo; // |a|² fora de [baixo, alto] dispara
+static int32_t base[3];                     // Linha de base por eixo, Q8
+static int32_t sta, lta;                    // Médias exponenciais da função característica, Q8
+static uint32_t aquecimento;                // Amostras até a LTA valer
+static bool base_pronta;
+
+void trigger_reiniciar(void){
+    uint32_t thr = trigger_cfg.limiar_mg * TRIGGER_1G / 1000;
+    limiar_alto = (TRIGGER_1G + thr) * (TRIGGER_1G + thr);
+    limiar_baixo = thr < TRIGGER_1G ? (TRIGGER_1G - thr) * (TRIGGER_1G - thr) : 0;
+    sta = lta = 0;
+    base_pronta = false;
+    aquecimento = 2u << TRIGGER_LTA_SHIFT;
+    hist_cabeca = hist_cauda = 0;
+    if (trigger_cfg.pre > TRIGGER_PRE_MAX) trigger_cfg.pre = TRIGGER_PRE_MAX;
+}
+
+static bool detecta_limiar(const int16_t *c){
+    uint32_t m2 = 0;
+    for (int i = 0; i < 3; i++) m2 += (uint32_t)((int32_t)c[i] * c[i]);
+    return m2 > limiar_alto || m2 < limiar_baixo;
+}
+
+static bool detecta_stalta(const int16_t *c){
+    // Função característica: norma L1 da aceleração sem a linha de base (sem raiz, sem float)
+    int32_t e = 0;
+    for (int i = 0; i < 3; i++){
+        int32_t v = (int32_t)c[i] << 8;
+        if (!base_pronta) base[i] = v;
+        base[i] += (v - base[i]) >> TRIGGER_BASE_SHIFT;
+        int32_t d = (v - base[i]) >> 8;
+        e += d < 0 ? -d : d;
+    }
+    base_pronta = true;
+    e <<= 8;
+    sta += (e - sta) >> TRIGGER_STA_SHIFT;
+    lta += (e - lta) >> TRIGGER_LTA_SHIFT;
+    if (aquecimento){
+        aquecimento--;
+        return false;
+    }
+    int32_t ref = lta > (TRIGGER_PISO << 8) ? lta : (TRIGGER_PISO << 8);
+    return (int64_t)sta * 10 > (int64_t)ref * trigger_cfg.razao_x10;
+}
+
+bool trigger_amostra(const amostra_t *a){
+    uint32_t cap = trigger_cfg.pre;
+    if (cap){
+        if (hist_cabeca - hist_cauda >= cap) hist_cauda++; // Cheio: perde a mais antiga
+        historico[hist_cabeca++ & (TRIGGER_PRE_MAX - 1)] = *a;
+    }
+    switch (trigger_cfg.modo){
+        case TRIGGER_LIMIAR: return detecta_limiar(a->canais);
+        case TRIGGER_STALTA: return detecta_stalta(a->canais);
+        default: return true;
+    }
+}
+
+const amostra_t *trigger_historico(void){
+    if (hist_cauda == hist_cabeca) return NULL;
+    return &historico[hist_cauda & (TRIGGER_PRE_MAX - 1)];
+}
+
+void trigger_descartar(void){
+    if (hist_cauda != hist_cabeca) hist_cauda++;
+}
+
+void trigger_limpar_historico(void){
+    hist_cauda = hist_cabeca;
+}
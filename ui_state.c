@@ -0,0 +1,49 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "lib/ui_state.h"
+
+static ui_estado_t estado;
+static volatile uint32_t geracao_atual;
+static ui_telemetria_t telemetria;
+static volatile uint32_t geracao_telemetria;
+
+// Lado do leitor: copia e confere se nenhuma escrita começou no meio
+static bool copiar(volatile uint32_t *atual, void *copia, const void *fonte, size_t tam, uint32_t *geracao){
+    uint32_t g = *atual;
+    if (g == *geracao || (g & 1)) return false;
+    __dmb();
+    memcpy(copia, fonte, tam);
+    __dmb();
+    if (*atual != g) return false; // Escrita no meio da cópia: a próxima publicação acorda de novo
+    *geracao = g;
+    return true;
+}
+
+void ui_mostrar(bool alteracao, const char *texto){
+    geracao_atual++; // Ímpar: escrita em andamento
+    __dmb();
+    estado.alteracao = alteracao;
+    strncpy(estado.texto, texto, sizeof(estado.texto) - 1);
+    estado.texto[sizeof(estado.texto) - 1] = '\0';
+    __dmb();
+    geracao_atual++;
+    __sev(); // O core1 só redesenha quando acordado por uma publicação
+}
+
+bool ui_ler(ui_estado_t *copia, uint32_t *geracao){
+    return copiar(&geracao_atual, copia, &estado, sizeof(estado), geracao);
+}
+
+void ui_telemetria(const ui_telemetria_t *t){
+    geracao_telemetria++;
+    __dmb();
+    telemetria = *t;
+    __dmb();
+    geracao_telemetria++;
+    __sev();
+}
+
+bool ui_ler_telemetria(ui_telemetria_t *copia, uint32_t *geracao){
+    return copiar(&geracao_telemetria, copia, &telemetria, sizeof(telemetria), geracao);
+}
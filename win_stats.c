@@ -0,0 +1,73 @@
+#include "lib/win_stats.h"
+#include "lib/csv_fmt.h"
+
+const char win_stats_cabecalho[] =
+    "id0,n,"
+    "ax_min,ax_max,ax_media,ax_rms,ax_var,ay_min,ay_max,ay_media,ay_rms,ay_var,"
+    "az_min,az_max,az_media,az_rms,az_var,gx_min,gx_max,gx_media,gx_rms,gx_var,"
+    "gy_min,gy_max,gy_media,gy_rms,gy_var,gz_min,gz_max,gz_media,gz_rms,gz_var,"
+    "temp_min,temp_max,temp_media,temp_rms,temp_var\n";
+
+void win_stats_zerar(win_stats_t *w){
+    w->n = 0;
+    for (int i = 0; i < MPU6050_CANAIS; i++){
+        w->min[i] = INT16_MAX;
+        w->max[i] = INT16_MIN;
+        w->soma[i] = 0;
+        w->quad[i] = 0;
+    }
+}
+
+void win_stats_adicionar(win_stats_t *w, const amostra_t *a){
+    if (!w->n) w->id0 = a->id;
+    w->n++;
+    for (int i = 0; i < MPU6050_CANAIS; i++){
+        int32_t v = a->canais[i];
+        if (v < w->min[i]) w->min[i] = (int16_t)v;
+        if (v > w->max[i]) w->max[i] = (int16_t)v;
+        w->soma[i] += v;
+        w->quad[i] += (uint32_t)(v * v); // Até 2^30: cabe em 32 bits sem sinal
+    }
+}
+
+// Raiz quadrada inteira arredondada para baixo
+static uint32_t raiz(uint32_t x){
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2){
+        if (x >= r + bit){
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+size_t win_stats_registro(const win_stats_t *w, char *dst){
+    char *p = csv_fmt_u32(dst, w->id0);
+    *p++ = ',';
+    p = csv_fmt_u32(p, w->n);
+    uint64_t n = w->n ? w->n : 1;
+    for (int i = 0; i < MPU6050_CANAIS; i++){
+        int64_t s = w->soma[i];
+        // Média arredondada ao inteiro mais próximo (divisão de 64 bits só uma vez por janela)
+        int64_t media = s >= 0 ? (s + (int64_t)(n / 2)) / (int64_t)n : -((-s + (int64_t)(n / 2)) / (int64_t)n);
+        // n² · var = n · Σx² − (Σx)², exato com n <= 65535
+        uint64_t s2 = (uint64_t)(s < 0 ? -s : s);
+        uint64_t var = (n * w->quad[i] - s2 * s2) / (n * n);
+        uint32_t rms = raiz((uint32_t)(w->quad[i] / n));
+        *p++ = ',';
+        p = csv_fmt_i32(p, w->n ? w->min[i] : 0);
+        *p++ = ',';
+        p = csv_fmt_i32(p, w->n ? w->max[i] : 0);
+        *p++ = ',';
+        p = csv_fmt_i32(p, (int32_t)media);
+        *p++ = ',';
+        p = csv_fmt_u32(p, rms);
+        *p++ = ',';
+        p = csv_fmt_u32(p, (uint32_t)var);
+    }
+    *p++ = '\n';
+    return (size_t)(p - dst);
+}